@@ -10,9 +10,13 @@
 #ifndef MAX30102_HPP
 #define MAX30102_HPP
 
+#if defined(__AVR__)
 #include <avr/io.h>
+#endif
 #include <stdint.h>
 #include <stdbool.h>
+#include "twi_master.h"
+#include "amostragem.h"
 
 // =============================================================================
 // Definições de registradores do MAX30102
@@ -104,19 +108,118 @@
 #define MAX30102_SAMPLEAVG_32       0xA0
 
 #define MAX30102_ROLLOVER_EN        0x10
+
+// Die Temperature Config
+#define MAX30102_TEMP_EN            0x01  // uma conversao (~29 ms), apaga sozinho
 #define MAX30102_A_FULL_MASK        0x0F
 
 // Constantes
 #define MAX30102_FIFO_SIZE          32
 #define MAX30102_PART_ID_VALUE      0x15
 
+// Configuracao recusada por max30102Configura (fora das opcoes do chip ou da taxa do DSP)
+#define MAX30102_ERR_CONFIG         0x0200
+
+// =============================================================================
+// Tipos
+// =============================================================================
+
+// Amostra da FIFO ja reconstruida (18 bits por canal)
+typedef struct {
+    uint32_t red;
+    uint32_t ir;
+} max30102Sample_t;
+
+// Aquisicao: valores em unidades fisicas, convertidos para os campos dos registradores
+typedef struct {
+    uint16_t taxaSps;           // 50, 100, 200, 400, 800, 1000, 1600, 3200
+    uint8_t  media;             // media no chip antes da FIFO: 1, 2, 4, 8, 16, 32
+    uint16_t larguraPulsoUs;    // 69, 118, 215, 411
+    uint16_t faixaAdcNa;        // 2048, 4096, 8192, 16384
+    uint8_t  aFull;             // amostras na FIFO que levantam A_FULL: 17..32
+    bool     rollover;          // FIFO cheia sobrescreve as amostras mais antigas
+} max30102Config_t;
+
+// Configuracao padrao do firmware (amostragem.h)
+#define MAX30102_CONFIG_PADRAO  { MAX30102_PADRAO_TAXA_SPS, MAX30102_PADRAO_MEDIA, \
+                                  MAX30102_PADRAO_PW_US, MAX30102_PADRAO_FAIXA_NA, \
+                                  MAX30102_PADRAO_A_FULL, true }
+
+// As funcoes de acesso devolvem SUCCESS ou o codigo TW_ERR_* do barramento (twi_master.h)
+
 bool initMAX30102();
-void readFIFO(uint32_t* red, uint32_t* ir);
-uint8_t getAvailableSamples();
 
-//Twi function
-uint8_t readRegister(uint8_t reg);
-void writeRegister(uint8_t reg, uint8_t value);
+// Grava SPO2_CONFIG e FIFO_CONFIG. MAX30102_ERR_CONFIG (nada e escrito) se algum
+// campo nao for uma das opcoes do chip. A combinacao taxa x largura de pulso nao e
+// conferida: ver a tabela de configuracoes permitidas no datasheet.
+// Taxa e media sao fixas em tempo de compilacao (amostragem.h): o DSP so vale para
+// MAX30102_PADRAO_TAXA_EFETIVA_MHZ, e taxa / media diferente tambem da
+// MAX30102_ERR_CONFIG. Em execucao so mudam largura de pulso, faixa, aFull e rollover.
+ret_code_t max30102Configura(const max30102Config_t* config);
+
+// Ultima configuracao aceita e sua taxa de saida da FIFO (taxa / media), em mHz
+const max30102Config_t* max30102Config(void);
+uint32_t max30102TaxaEfetivaMHz(void);
+
+// Modo de proximidade (lib/MAX30102/presenca.h): corrente do LED piloto e limiar
+// (8 MSBs do ADC) e habilita PROX_INT. ArmaProximidade zera a FIFO e regrava
+// MODE_CONFIG, o que devolve o chip ao modo de proximidade ate o proximo PROX_INT.
+ret_code_t max30102Proximidade(uint8_t pilotPa, uint8_t limiar);
+ret_code_t max30102ArmaProximidade(void);
+
+// Temperatura do die: Inicia dispara uma conversao, que termina com DIE_TEMP_RDY
+// (habilitado em INT_ENABLE_2 pelo init); Le devolve DIE_TEMP_INT/FRAC em 1/16 C.
+ret_code_t max30102TemperaturaInicia(void);
+ret_code_t max30102TemperaturaLe(int16_t* tempQ4);
+
+// Ganho (lib/MAX30102/ganho.h): so grava o que difere do valor atual.
+// faixaNa: 2048, 4096, 8192, 16384; pa: 0.2 mA por passo (LED1_PA = RED, LED2_PA = IR)
+ret_code_t max30102FaixaAdc(uint16_t faixaNa);
+ret_code_t max30102Leds(uint8_t paRed, uint8_t paIr);
+ret_code_t readFIFO(uint32_t* red, uint32_t* ir);
+ret_code_t getAvailableSamples(uint8_t* count);
+
+// Le todas as amostras disponiveis (limitado a maxCount) em uma unica transacao I2C.
+// count recebe a quantidade de amostras escritas em samples (0 em caso de erro).
+ret_code_t readFIFOBurst(max30102Sample_t* samples, uint8_t maxCount, uint8_t* count);
+
+// Versao nao bloqueante da leitura em rajada, conduzida por TWI_vect.
+// startFIFOBurst retorna false se uma drenagem ja estiver em andamento;
+// pollFIFOBurst retorna true (uma vez) quando samples estiver pronto, com count amostras
+// e o resultado da transacao em status (pode ser NULL).
+bool startFIFOBurst(max30102Sample_t* samples, uint8_t maxCount);
+bool pollFIFOBurst(uint8_t* count, ret_code_t* status);
+
+// Amostras descartadas pelo rollover (OVF_COUNTER, lido na mesma rajada dos
+// ponteiros) antes do ultimo bloco entregue por pollFIFOBurst, e o acumulado
+// desde o reset. OVF_COUNTER satura em 31: perdas maiores contam como 31.
+uint8_t max30102PerdidasBloco(void);
+uint32_t max30102PerdidasTotal(void);
+
+// FIFO com WR_PTR == RD_PTR e OVF_COUNTER = 0 pode estar vazia ou cheia: a drenagem
+// e getAvailableSamples releem INT_STATUS_1..RD_PTR e usam o A_FULL. Essa leitura
+// limpa o status; os bits lidos sao somados (OR) em status[0..1] e esquecidos.
+// Chamar com a drenagem parada, junto da leitura de INT_STATUS_1..2 do chamador.
+void max30102StatusPendente(uint8_t status[2]);
+
+// Sombra dos registradores de configuracao (INT_ENABLE_1..2, FIFO_CONFIG, MODE_CONFIG,
+// SPO2_CONFIG, LED1_PA, LED2_PA, PILOT_PA, MULTI_LED_CTRL1..2). CacheEscreve so marca o
+// registrador como sujo se o valor mudar; CacheFlush grava os sujos em ordem de endereco,
+// em rajadas com auto-incremento (registradores limpos entre dois sujos proximos sao
+// regravados para unir as rajadas). Em falha os sujos continuam pendentes.
+void max30102CacheEscreve(uint8_t reg, uint8_t valor);
+uint8_t max30102CacheLe(uint8_t reg);
+bool max30102CacheSujo(void);
+ret_code_t max30102CacheFlush(void);
+
+// MODE_RESET: a sombra volta aos valores de power-on; retorna quando o chip libera RESET
+ret_code_t max30102Reset(void);
+
+//Twi function: readRegister le da sombra os registradores de configuracao;
+//readRegisters vai sempre ao barramento; writeRegister grava direto e atualiza a sombra
+ret_code_t readRegister(uint8_t reg, uint8_t* value);
+ret_code_t readRegisters(uint8_t reg, uint8_t* data, uint8_t len);
+ret_code_t writeRegister(uint8_t reg, uint8_t value);
 
 
 #endif // MAX30102_HPP
\ No newline at end of file
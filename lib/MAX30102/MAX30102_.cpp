@@ -3,97 +3,547 @@
 #include "funsape/funsapeLibGlobalDefines.hpp"
 #include "funsape/peripheral/funsapeLibInt0.hpp"
 
-void writeRegister(uint8_t reg, uint8_t value) {
+// Sombra dos registradores de configuracao (INT_ENABLE_1..MULTI_LED_CTRL2).
+// Um bit por registrador a partir de CACHE_INICIO; reservados e FIFO ficam de fora.
+#define CACHE_INICIO    MAX30102_INT_ENABLE_1
+#define CACHE_TAMANHO   (MAX30102_MULTI_LED_CTRL2 - CACHE_INICIO + 1)
+#define CACHE_BIT(reg)  (1UL << ((reg) - CACHE_INICIO))
+#define CACHE_PONTE     2   // limpos regravados para unir dois trechos (1 byte cada,
+                            // contra START + endereco + registrador + STOP)
+
+static const uint32_t cacheaveis = CACHE_BIT(MAX30102_INT_ENABLE_1) | CACHE_BIT(MAX30102_INT_ENABLE_2) |
+                                   CACHE_BIT(MAX30102_FIFO_CONFIG)  | CACHE_BIT(MAX30102_MODE_CONFIG) |
+                                   CACHE_BIT(MAX30102_SPO2_CONFIG)  | CACHE_BIT(MAX30102_LED1_PA) |
+                                   CACHE_BIT(MAX30102_LED2_PA)      | CACHE_BIT(MAX30102_PILOT_PA) |
+                                   CACHE_BIT(MAX30102_MULTI_LED_CTRL1) | CACHE_BIT(MAX30102_MULTI_LED_CTRL2);
+
+static uint8_t  sombra[CACHE_TAMANHO];  // valores de power-on: todos 0x00
+static uint32_t sujos = 0;
+
+static inline bool cacheavel(uint8_t reg) {
+    return reg >= CACHE_INICIO && reg < CACHE_INICIO + CACHE_TAMANHO &&
+           (cacheaveis & CACHE_BIT(reg));
+}
+
+// Escrita direta; mantem a sombra coerente
+ret_code_t writeRegister(uint8_t reg, uint8_t value) {
     uint8_t data[2] = {reg, value};
-    tw_master_transmit(MAX30102_I2C_ADDRESS, data, 2, false);
+    ret_code_t error_code = tw_master_transmit(MAX30102_I2C_ADDRESS, data, 2, false);
+    if (error_code == SUCCESS && cacheavel(reg)) {
+        sombra[reg - CACHE_INICIO] = value;
+        sujos &= ~CACHE_BIT(reg);
+    }
+    return error_code;
+}
+
+void max30102CacheEscreve(uint8_t reg, uint8_t valor) {
+    if (!cacheavel(reg) || sombra[reg - CACHE_INICIO] == valor) {
+        return;
+    }
+    sombra[reg - CACHE_INICIO] = valor;
+    sujos |= CACHE_BIT(reg);
+}
+
+uint8_t max30102CacheLe(uint8_t reg) {
+    return cacheavel(reg) ? sombra[reg - CACHE_INICIO] : 0;
+}
+
+bool max30102CacheSujo(void) {
+    return sujos != 0;
+}
+
+ret_code_t max30102CacheFlush(void) {
+    uint8_t dados[1 + CACHE_TAMANHO];
+    uint8_t i = 0;
+
+    while (i < CACHE_TAMANHO) {
+        if (!(sujos & (1UL << i))) {
+            i++;
+            continue;
+        }
+
+        // Trecho com auto-incremento: segue por registradores cacheaveis enquanto o
+        // proximo sujo estiver a ate CACHE_PONTE limpos de distancia
+        uint8_t fim = i;
+        for (uint8_t j = i + 1; j < CACHE_TAMANHO && (cacheaveis & (1UL << j)); j++) {
+            if (sujos & (1UL << j)) {
+                fim = j;
+            } else if (j - fim > CACHE_PONTE) {
+                break;
+            }
+        }
+
+        uint8_t len = fim - i + 1;
+        dados[0] = CACHE_INICIO + i;
+        for (uint8_t k = 0; k < len; k++) {
+            dados[1 + k] = sombra[i + k];
+        }
+
+        // Em falha os bits continuam sujos: o proximo flush tenta de novo
+        ret_code_t error_code = tw_master_transmit(MAX30102_I2C_ADDRESS, dados, len + 1, false);
+        if (error_code != SUCCESS) {
+            return error_code;
+        }
+        for (uint8_t k = i; k <= fim; k++) {
+            sujos &= ~(1UL << k);
+        }
+        i = fim + 1;
+    }
+    return SUCCESS;
+}
+
+ret_code_t max30102Reset(void) {
+    ret_code_t error_code = writeRegister(MAX30102_MODE_CONFIG, MAX30102_MODE_RESET);
+    if (error_code != SUCCESS) {
+        return error_code;
+    }
+
+    // O chip volta aos valores de power-on (todos 0x00) e limpa RESET ao terminar
+    for (uint8_t i = 0; i < CACHE_TAMANHO; i++) {
+        sombra[i] = 0x00;
+    }
+    sujos = 0;
+
+    uint8_t modo = MAX30102_MODE_RESET;
+    for (uint8_t tentativas = 100; tentativas && (modo & MAX30102_MODE_RESET); tentativas--) {
+        delayMs(1);
+        error_code = readRegisters(MAX30102_MODE_CONFIG, &modo, 1);
+        if (error_code != SUCCESS) {
+            return error_code;
+        }
+    }
+    return (modo & MAX30102_MODE_RESET) ? TW_ERR_TIMEOUT : SUCCESS;
+}
+
+// Le len registradores a partir de reg (auto-incremento) em uma unica transacao
+ret_code_t readRegisters(uint8_t reg, uint8_t* data, uint8_t len) {
+    tw_xfer_t xfer = {};
+
+    xfer.addr   = MAX30102_I2C_ADDRESS;
+    xfer.type   = TW_XFER_WRITE_READ;
+    xfer.p_wr   = &reg;
+    xfer.wr_len = 1;
+    xfer.p_rd   = data;
+    xfer.rd_len = len;
+
+    while (tw_submit(&xfer) == TW_ERR_QUEUE_FULL) {
+        tw_poll();
+    }
+    return tw_wait(&xfer);
+}
+
+// Ler registrador: os de configuracao vem da sombra, sem I2C
+ret_code_t readRegister(uint8_t reg, uint8_t* value) {
+    if (cacheavel(reg)) {
+        *value = sombra[reg - CACHE_INICIO];
+        return SUCCESS;
+    }
+    return readRegisters(reg, value, 1);
 }
 
-// Ler registrador
-uint8_t readRegister(uint8_t reg) {
-    uint8_t value;
-    tw_master_transmit(MAX30102_I2C_ADDRESS, &reg, 1, true);
-    tw_master_receive(MAX30102_I2C_ADDRESS, &value, 1);
-    return value;
+// Amostras na FIFO a partir de WR_PTR, OVF_COUNTER e RD_PTR. Com a FIFO cheia os
+// ponteiros coincidem, como vazia; OVF_COUNTER > 0 so acontece com ela cheia.
+static inline uint8_t amostrasNaFifo(const uint8_t* ptrs) {
+    if (ptrs[1] != 0) {
+        return MAX30102_FIFO_SIZE;
+    }
+    return (ptrs[0] - ptrs[2]) & (MAX30102_FIFO_SIZE - 1);
 }
 
-void readFIFO(uint32_t* red, uint32_t* ir) {
-    uint8_t reg = MAX30102_FIFO_DATA;
+// Ponteiros iguais sem OVF_COUNTER: vazia, ou cheia com exatamente 32 amostras e
+// nenhuma perdida ainda. Precisa de ler INT_STATUS_1..RD_PTR de novo.
+static inline bool fifoAmbigua(const uint8_t* ptrs) {
+    return ptrs[1] == 0 && ptrs[0] == ptrs[2];
+}
+
+// Releitura de INT_STATUS_1..RD_PTR numa so rajada. Cheia se o OVF_COUNTER relido
+// passou de 0 ou se o A_FULL esta levantado: ele so volta a 0 na leitura do
+// status, e o ultimo status lido (depois da drenagem anterior) tinha a FIFO quase
+// vazia. Os bits de status lidos aqui ficam em statusPendente para quem ler depois.
+static uint8_t statusPendente[2];
+
+static uint8_t amostrasNaFifoRelida(const uint8_t* regs, uint8_t* ptrs) {
+    statusPendente[0] |= regs[0];
+    statusPendente[1] |= regs[1];
+    ptrs[0] = regs[MAX30102_FIFO_WR_PTR];
+    ptrs[1] = regs[MAX30102_OVF_COUNTER];
+    ptrs[2] = regs[MAX30102_FIFO_RD_PTR];
+    if (fifoAmbigua(ptrs) && (regs[0] & MAX30102_INT_A_FULL)) {
+        return MAX30102_FIFO_SIZE;
+    }
+    return amostrasNaFifo(ptrs);
+}
+
+// Reconstroi um valor de 18 bits a partir de 3 bytes da FIFO
+static inline uint32_t unpack18(const uint8_t* data) {
+    uint32_t value = ((uint32_t)data[0] << 16) | ((uint32_t)data[1] << 8) | data[2];
+    return value & 0x03FFFF;  // Mask para 18 bits
+}
+
+ret_code_t readFIFO(uint32_t* red, uint32_t* ir) {
     uint8_t fifo_data[6]; // 3 bytes RED + 3 bytes IR
 
-    // Point to FIFO data register
-    tw_master_transmit(MAX30102_I2C_ADDRESS, &reg, 1, true);
     // Read 6 bytes (even in heart rate mode, read full sample)
-    tw_master_receive(MAX30102_I2C_ADDRESS, fifo_data, 6);
+    ret_code_t error_code = readRegisters(MAX30102_FIFO_DATA, fifo_data, 6);
+    if (error_code != SUCCESS) {
+        return error_code;
+    }
 
     // Reconstruct 18-bit values
-    *red = ((uint32_t)fifo_data[0] << 16) | ((uint32_t)fifo_data[1] << 8) | fifo_data[2];
-    *red &= 0x03FFFF;  // Mask para 18 bits
+    *red = unpack18(&fifo_data[0]);
+    *ir  = unpack18(&fifo_data[3]);
+    return SUCCESS;
+}
+
+// Estado da drenagem assincrona da FIFO
+typedef enum {
+    FIFO_BURST_IDLE,
+    FIFO_BURST_PONTEIROS,   // lendo WR_PTR..RD_PTR
+    FIFO_BURST_STATUS,      // ponteiros iguais: relendo INT_STATUS_1..RD_PTR
+    FIFO_BURST_DADOS,       // lendo count * 6 bytes de FIFO_DATA
+    FIFO_BURST_PRONTO
+} fifoBurstEstado_t;
+
+static volatile fifoBurstEstado_t burstEstado = FIFO_BURST_IDLE;
+static max30102Sample_t* burstAmostras;
+static uint8_t burstMax;
+static volatile uint8_t burstCount;
+static volatile ret_code_t burstStatus;
+static uint8_t burstPonteiros[3];   // WR_PTR, OVF_COUNTER, RD_PTR
+static uint8_t burstRegistros[MAX30102_FIFO_RD_PTR + 1];  // INT_STATUS_1..RD_PTR
+static uint8_t  perdidasBloco = 0;
+static uint32_t perdidasTotal = 0;
+static const uint8_t burstRegPonteiros = MAX30102_FIFO_WR_PTR;
+static const uint8_t burstRegStatus = MAX30102_INT_STATUS_1;
+static const uint8_t burstRegDados = MAX30102_FIFO_DATA;
+static tw_xfer_t burstXfer;
+
+// Chamado em TWI_vect ao fim de cada etapa da drenagem
+static void fifoBurstCallback(tw_xfer_t* xfer) {
+    burstStatus = xfer->status;
+    if (xfer->status != SUCCESS) {
+        // Amostras parciais sao descartadas; a FIFO sera lida de novo
+        burstCount = 0;
+        burstEstado = FIFO_BURST_PRONTO;
+        return;
+    }
+
+    if (burstEstado == FIFO_BURST_PONTEIROS && fifoAmbigua(burstPonteiros)) {
+        xfer->p_wr   = &burstRegStatus;
+        xfer->p_rd   = burstRegistros;
+        xfer->rd_len = sizeof(burstRegistros);
+        burstEstado  = FIFO_BURST_STATUS;
+        tw_submit(xfer);
+        return;
+    }
+
+    if (burstEstado == FIFO_BURST_PONTEIROS || burstEstado == FIFO_BURST_STATUS) {
+        uint8_t count = (burstEstado == FIFO_BURST_STATUS)
+                      ? amostrasNaFifoRelida(burstRegistros, burstPonteiros)
+                      : amostrasNaFifo(burstPonteiros);
+        if (count > burstMax) {
+            count = burstMax;
+        }
+        burstCount = count;
+        if (count == 0) {
+            burstEstado = FIFO_BURST_PRONTO;
+            return;
+        }
+
+        // Os bytes crus (6 por amostra) sao recebidos no proprio vetor do chamador,
+        // que reserva 8 bytes por amostra, evitando um segundo buffer de ate 192 bytes.
+        xfer->p_wr   = &burstRegDados;
+        xfer->p_rd   = (uint8_t*)burstAmostras;
+        xfer->rd_len = (uint8_t)(count * 6);
+        burstEstado  = FIFO_BURST_DADOS;
+        tw_submit(xfer);
+        return;
+    }
+
+    burstEstado = FIFO_BURST_PRONTO;
+}
+
+bool startFIFOBurst(max30102Sample_t* samples, uint8_t maxCount) {
+    if (burstEstado != FIFO_BURST_IDLE) {
+        return false;
+    }
+
+    burstAmostras = samples;
+    burstMax      = maxCount;
+    burstCount    = 0;
+    burstStatus   = SUCCESS;
+    burstEstado   = FIFO_BURST_PONTEIROS;
+
+    // Ponteiros e depois dados, ambos com REPEATED START e auto-incremento
+    burstXfer.addr     = MAX30102_I2C_ADDRESS;
+    burstXfer.type     = TW_XFER_WRITE_READ;
+    burstXfer.p_wr     = &burstRegPonteiros;
+    burstXfer.wr_len   = 1;
+    burstXfer.p_rd     = burstPonteiros;
+    burstXfer.rd_len   = sizeof(burstPonteiros);
+    burstXfer.no_stop  = false;
+    burstXfer.callback = fifoBurstCallback;
+
+    if (tw_submit(&burstXfer) != SUCCESS) {
+        burstEstado = FIFO_BURST_IDLE;
+        return false;
+    }
+    return true;
+}
+
+bool pollFIFOBurst(uint8_t* count, ret_code_t* status) {
+    if (burstEstado != FIFO_BURST_PRONTO) {
+        return false;
+    }
+
+    uint8_t n = burstCount;
+    uint8_t* raw = (uint8_t*)burstAmostras;
+
+    // Desempacota de tras para frente: a amostra i so sobrescreve bytes
+    // de amostras com indice maior, que ja foram convertidas.
+    for (int8_t i = n - 1; i >= 0; i--) {
+        const uint8_t* p = &raw[i * 6];
+        uint32_t red = unpack18(&p[0]);
+        uint32_t ir  = unpack18(&p[3]);
+        burstAmostras[i].red = red;
+        burstAmostras[i].ir  = ir;
+    }
+
+    // O chip zera OVF_COUNTER ao entregar uma amostra: so conta se o bloco saiu
+    perdidasBloco = (n != 0) ? burstPonteiros[1] : 0;
+    perdidasTotal += perdidasBloco;
+
+    *count = n;
+    if (status) {
+        *status = burstStatus;
+    }
+    burstEstado = FIFO_BURST_IDLE;
+    return true;
+}
+
+ret_code_t readFIFOBurst(max30102Sample_t* samples, uint8_t maxCount, uint8_t* count) {
+    ret_code_t error_code;
+
+    *count = 0;
+    if (!startFIFOBurst(samples, maxCount)) {
+        return TW_ERR_QUEUE_FULL;
+    }
+    // O callback encadeia ponteiros e dados no mesmo descritor, entao tw_wait
+    // so retorna quando a drenagem terminou (com sucesso ou erro)
+    tw_wait(&burstXfer);
+    pollFIFOBurst(count, &error_code);
+
+    return error_code;
+}
+
+
+// Opcoes de cada campo, na ordem do codigo no registrador
+static const uint16_t opcoesTaxa[]   = { 50, 100, 200, 400, 800, 1000, 1600, 3200 };
+static const uint16_t opcoesMedia[]  = { 1, 2, 4, 8, 16, 32 };
+static const uint16_t opcoesPulso[]  = { 69, 118, 215, 411 };
+static const uint16_t opcoesFaixa[]  = { 2048, 4096, 8192, 16384 };
+
+static max30102Config_t configAtual = MAX30102_CONFIG_PADRAO;
+
+// Indice de valor em opcoes, ou -1
+static int8_t codigo(const uint16_t* opcoes, uint8_t n, uint16_t valor) {
+    for (uint8_t i = 0; i < n; i++) {
+        if (opcoes[i] == valor) {
+            return (int8_t)i;
+        }
+    }
+    return -1;
+}
+
+// Valida e coloca SPO2_CONFIG e FIFO_CONFIG na sombra, sem I2C
+static ret_code_t configuraSombra(const max30102Config_t* config) {
+    int8_t taxa  = codigo(opcoesTaxa,  sizeof(opcoesTaxa)  / sizeof(opcoesTaxa[0]),  config->taxaSps);
+    int8_t media = codigo(opcoesMedia, sizeof(opcoesMedia) / sizeof(opcoesMedia[0]), config->media);
+    int8_t pulso = codigo(opcoesPulso, sizeof(opcoesPulso) / sizeof(opcoesPulso[0]), config->larguraPulsoUs);
+    int8_t faixa = codigo(opcoesFaixa, sizeof(opcoesFaixa) / sizeof(opcoesFaixa[0]), config->faixaAdcNa);
+
+    if (taxa < 0 || media < 0 || pulso < 0 || faixa < 0 ||
+        config->aFull < MAX30102_FIFO_SIZE - MAX30102_A_FULL_MASK || config->aFull > MAX30102_FIFO_SIZE) {
+        return MAX30102_ERR_CONFIG;
+    }
+    // O DSP (filtros, detector, janelas) e compilado para a taxa de amostragem.h
+    if (MAX30102_TAXA_EFETIVA_MHZ(config->taxaSps, config->media) != MAX30102_PADRAO_TAXA_EFETIVA_MHZ) {
+        return MAX30102_ERR_CONFIG;
+    }
+
+    uint8_t spo2_config = (uint8_t)(faixa << 5) | (uint8_t)(taxa << 2) | (uint8_t)pulso;
+
+    // FIFO_A_FULL conta as posicoes livres no momento da interrupcao
+    uint8_t fifo_config = (uint8_t)(media << 5) |
+                          (config->rollover ? MAX30102_ROLLOVER_EN : 0) |
+                          (uint8_t)(MAX30102_FIFO_SIZE - config->aFull);
+
+    max30102CacheEscreve(MAX30102_SPO2_CONFIG, spo2_config);
+    max30102CacheEscreve(MAX30102_FIFO_CONFIG, fifo_config);
+    configAtual = *config;
+    return SUCCESS;
+}
+
+ret_code_t max30102Configura(const max30102Config_t* config) {
+    ret_code_t error_code = configuraSombra(config);
+    if (error_code != SUCCESS) {
+        return error_code;
+    }
+    return max30102CacheFlush();
+}
+
+const max30102Config_t* max30102Config(void) {
+    return &configAtual;
+}
 
-    *ir = ((uint32_t)fifo_data[3] << 16) | ((uint32_t)fifo_data[4] << 8) | fifo_data[5];
-    *ir &= 0x03FFFF;   // Mask para 18 bits
+uint32_t max30102TaxaEfetivaMHz(void) {
+    return MAX30102_TAXA_EFETIVA_MHZ(configAtual.taxaSps, configAtual.media);
 }
 
+ret_code_t max30102FaixaAdc(uint16_t faixaNa) {
+    if (faixaNa == configAtual.faixaAdcNa) {
+        return SUCCESS;
+    }
+    max30102Config_t config = configAtual;
+    config.faixaAdcNa = faixaNa;
+    return max30102Configura(&config);
+}
+
+ret_code_t max30102Leds(uint8_t paRed, uint8_t paIr) {
+    // LED1_PA e LED2_PA sao vizinhos: as duas mudancas saem numa transacao
+    max30102CacheEscreve(MAX30102_LED1_PA, paRed);
+    max30102CacheEscreve(MAX30102_LED2_PA, paIr);
+    return max30102CacheFlush();
+}
+
+ret_code_t max30102Proximidade(uint8_t pilotPa, uint8_t limiar) {
+    // PROX_INT_THRESH fica fora da sombra (0x30)
+    ret_code_t error_code = writeRegister(MAX30102_PROX_INT_THRESH, limiar);
+    if (error_code != SUCCESS) {
+        return error_code;
+    }
+    max30102CacheEscreve(MAX30102_PILOT_PA, pilotPa);
+    max30102CacheEscreve(MAX30102_INT_ENABLE_1,
+                         max30102CacheLe(MAX30102_INT_ENABLE_1) | MAX30102_INT_PROX_INT);
+    return max30102CacheFlush();
+}
+
+ret_code_t max30102ArmaProximidade(void) {
+    // FIFO zerada: as amostras da aquisicao anterior nao chegam depois do PROX_INT
+    uint8_t ponteiros[4] = { MAX30102_FIFO_WR_PTR, 0x00, 0x00, 0x00 };
+    ret_code_t error_code = tw_master_transmit(MAX30102_I2C_ADDRESS, ponteiros, sizeof(ponteiros), false);
+    if (error_code != SUCCESS) {
+        return error_code;
+    }
+    // O chip so volta ao modo de proximidade quando MODE_CONFIG e regravado, mesmo
+    // com o mesmo valor: escrita direta, a sombra descartaria a repeticao
+    return writeRegister(MAX30102_MODE_CONFIG, max30102CacheLe(MAX30102_MODE_CONFIG));
+}
+
+ret_code_t max30102TemperaturaInicia(void) {
+    // DIE_TEMP_CONFIG fica fora da sombra: TEMP_EN se apaga no fim da conversao
+    return writeRegister(MAX30102_DIE_TEMP_CONFIG, MAX30102_TEMP_EN);
+}
+
+ret_code_t max30102TemperaturaLe(int16_t* tempQ4) {
+    // DIE_TEMP_INT (complemento de 2, graus) e DIE_TEMP_FRAC (4 bits, 1/16 C) numa leitura
+    uint8_t temp[2];
+    ret_code_t error_code = readRegisters(MAX30102_DIE_TEMP_INT, temp, 2);
+    if (error_code != SUCCESS) {
+        return error_code;
+    }
+    *tempQ4 = (int16_t)((int8_t)temp[0] * 16 + (temp[1] & 0x0F));
+    return SUCCESS;
+}
 
 bool initMAX30102() {
 
+    uint8_t status[2];
+
     // Inicializar TWI
     tw_init(TW_FREQ_400K, false);
 
-    // Ler PART_ID (registrador 0xFF)
-    uint8_t reg_addr = 0xFF;
+    // Valida a existencia do max30102 (PART_ID, registrador 0xFF)
     uint8_t part_id;
-
-    // Valida a existencia do max30102
-    tw_master_transmit(MAX30102_I2C_ADDRESS, &reg_addr, 1, true);
-    tw_master_receive(MAX30102_I2C_ADDRESS, &part_id, 1);
-
-    if (part_id != 0x15) { // Expected PART_ID for MAX30102
+    if (readRegister(MAX30102_PART_ID, &part_id) != SUCCESS || part_id != MAX30102_PART_ID_VALUE) {
         return false;
     }
 
-    //setup
-    writeRegister(MAX30102_MODE_CONFIG, MAX30102_MODE_RESET);
-    writeRegister(MAX30102_MODE_CONFIG, MAX30102_MODE_HEART_RATE);
-    delayMs(100);
+    //setup: reset espera o chip liberar RESET (~1 ms) em vez de 100 ms fixos
+    if (max30102Reset() != SUCCESS) {
+        return false;
+    }
 
+    // Toda a configuracao vai para a sombra e sai em quatro rajadas com
+    // auto-incremento: INT_ENABLE_1..2, FIFO_CONFIG..SPO2_CONFIG, LED1_PA..LED2_PA e PILOT_PA
 
-    //Configuracao de sensibilide do max30102
-    uint8_t spo2_config = MAX30102_SPO2_ADC_RGE_16384 |  // Sensibilidade do adc de leiutra
-                         MAX30102_SPO2_SR_1000 |         // max30102 sample rate
-                         MAX30102_SPO2_PW_215;           // resolucao do adc -- atual esta em 17 bits
-    writeRegister(MAX30102_SPO2_CONFIG, spo2_config);
+    // Amostragem (amostragem.h): 1000 sps com media de 16 no chip entrega 62.5 Hz
+    // direto na FIFO, 16x menos I2C que a media em software; A_FULL com 17 amostras
+    const max30102Config_t config = MAX30102_CONFIG_PADRAO;
+    if (configuraSombra(&config) != SUCCESS) {
+        return false;
+    }
+    max30102CacheEscreve(MAX30102_MODE_CONFIG, MAX30102_MODE_SPO2);   // RED + IR na FIFO (6 bytes/amostra)
 
+    // IMPORTANTE: Configura interrupções do MAX30102. Com PROX_INT_EN gravado antes de
+    // MODE_CONFIG (a rajada segue a ordem dos enderecos) o chip comeca no modo de
+    // proximidade, com o LED piloto, ate um dedo passar de PROX_INT_THRESH.
+    max30102CacheEscreve(MAX30102_INT_ENABLE_1, MAX30102_INT_A_FULL |  // FIFO Almost Full
+                                                MAX30102_INT_PROX_INT);// e dedo detectado
+    max30102CacheEscreve(MAX30102_INT_ENABLE_2, MAX30102_INT_DIE_TEMP_RDY); // fim da conversao de temperatura
+    max30102CacheEscreve(MAX30102_PILOT_PA, MAX30102_PADRAO_PILOT_PA);
+    if (writeRegister(MAX30102_PROX_INT_THRESH, MAX30102_PADRAO_LIMIAR_PROX) != SUCCESS) {
+        return false;
+    }
 
-    //Configura avg da fifo e habilita INT0 do MAX para quando a fifo estiver com X samples configuradas
-    uint8_t fifo_config = MAX30102_SAMPLEAVG_1 |
-                         MAX30102_ROLLOVER_EN |         // Habilita rollover
-                         0x02;                          // 30 amostra levanta INT0
-    writeRegister(MAX30102_FIFO_CONFIG, fifo_config);
+    //Red e IR led config: corrente inicial, ajustada depois pelo controle de ganho
+    max30102CacheEscreve(MAX30102_LED1_PA, MAX30102_PADRAO_LED_PA);
+    max30102CacheEscreve(MAX30102_LED2_PA, MAX30102_PADRAO_LED_PA);
 
-    // IMPORTANTE: Configura interrupções do MAX30102
-    writeRegister(MAX30102_INT_ENABLE_1, MAX30102_INT_A_FULL);  // Apenas FIFO Almost Full
-    writeRegister(MAX30102_INT_ENABLE_2, 0x00);                 // Não usar temperatura
+    // Qualquer falha de barramento invalida a configuracao: para na primeira
+    if (max30102CacheFlush() != SUCCESS) {
+        return false;
+    }
 
     // Limpar quaisquer interrupções pendentes lendo os registradores de status
-    readRegister(MAX30102_INT_STATUS_1);
-    readRegister(MAX30102_INT_STATUS_2);
+    return readRegisters(MAX30102_INT_STATUS_1, status, 2) == SUCCESS;
+}
 
-    //Red e IR led config
-    writeRegister(MAX30102_LED1_PA, 0x60);
-    writeRegister(MAX30102_LED2_PA, 0x60);
+ret_code_t getAvailableSamples(uint8_t* count) {
+    uint8_t ptrs[3];    // WR_PTR, OVF_COUNTER, RD_PTR
 
-    return true;
+    ret_code_t error_code = readRegisters(MAX30102_FIFO_WR_PTR, ptrs, 3);
+    if (error_code != SUCCESS) {
+        *count = 0;
+        return error_code;
+    }
+
+    if (fifoAmbigua(ptrs)) {
+        uint8_t regs[MAX30102_FIFO_RD_PTR + 1];
+        error_code = readRegisters(MAX30102_INT_STATUS_1, regs, sizeof(regs));
+        if (error_code != SUCCESS) {
+            *count = 0;
+            return error_code;
+        }
+        *count = amostrasNaFifoRelida(regs, ptrs);
+        return SUCCESS;
+    }
 
+    *count = amostrasNaFifo(ptrs);
+    return SUCCESS;
+}
 
+void max30102StatusPendente(uint8_t status[2]) {
+    status[0] |= statusPendente[0];
+    status[1] |= statusPendente[1];
+    statusPendente[0] = 0;
+    statusPendente[1] = 0;
 }
 
-uint8_t getAvailableSamples() {
-    uint8_t write_ptr = readRegister(MAX30102_FIFO_WR_PTR);
-    uint8_t read_ptr = readRegister(MAX30102_FIFO_RD_PTR);
+uint8_t max30102PerdidasBloco(void) {
+    return perdidasBloco;
+}
 
-    if (write_ptr >= read_ptr) {
-        return write_ptr - read_ptr;
-    } else {
-        return (32 - read_ptr) + write_ptr;
-    }
+uint32_t max30102PerdidasTotal(void) {
+    return perdidasTotal;
 }
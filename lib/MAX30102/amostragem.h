@@ -0,0 +1,33 @@
+//!
+//! \file           amostragem.h
+//! \brief          Configuracao padrao de amostragem do MAX30102, compartilhada com o DSP
+//! \author         Paulo Donizete Antunes Junior
+//! \date           2025-08-23
+//! \version        1.0
+//! \details        O MAX30102 amostra a MAX30102_PADRAO_TAXA_SPS e tira a media de
+//!                 MAX30102_PADRAO_MEDIA amostras antes da FIFO. A taxa efetiva
+//!                 (taxa / media) e a taxa do DSP: calcMaster.h deriva SAMPLE_RATE
+//!                 e as constantes de tempo do detector dela. So macros, sem
+//!                 dependencias: compila tambem no PC.
+//!
+
+#ifndef AMOSTRAGEM_H
+#define AMOSTRAGEM_H
+
+#include <stdint.h>
+
+#define MAX30102_PADRAO_TAXA_SPS    1000    // 50, 100, 200, 400, 800, 1000, 1600, 3200
+#define MAX30102_PADRAO_MEDIA       16      // media no chip: 1, 2, 4, 8, 16, 32
+#define MAX30102_PADRAO_PW_US       215     // 69, 118, 215, 411 (15 a 18 bits)
+#define MAX30102_PADRAO_FAIXA_NA    16384   // fundo de escala: 2048, 4096, 8192, 16384 nA
+#define MAX30102_PADRAO_A_FULL      17      // amostras na FIFO que levantam A_FULL (17..32)
+#define MAX30102_PADRAO_LED_PA      0x60    // corrente inicial dos LEDs: 0.2 mA por passo (19.2 mA)
+#define MAX30102_PADRAO_PILOT_PA    0x19    // LED IR no modo de proximidade (5 mA)
+#define MAX30102_PADRAO_LIMIAR_PROX 0x02    // PROX_INT_THRESH: 8 MSBs do ADC (2 * 1024 contagens)
+
+// Taxa de saida da FIFO em mHz
+#define MAX30102_TAXA_EFETIVA_MHZ(taxa, media)  ((uint32_t)(taxa) * 1000UL / (media))
+#define MAX30102_PADRAO_TAXA_EFETIVA_MHZ        MAX30102_TAXA_EFETIVA_MHZ(MAX30102_PADRAO_TAXA_SPS, \
+                                                                          MAX30102_PADRAO_MEDIA)
+
+#endif // AMOSTRAGEM_H
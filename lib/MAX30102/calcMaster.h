@@ -7,16 +7,185 @@
 //! \details        Cálculo de tendência, detecção de vales e cálculo do BPM
 //!
 
-#include "../lib/funsape/funsapeLibGlobalDefines.hpp"
+#ifndef CALCMASTER_H
+#define CALCMASTER_H
+
+#include <stdint.h>     // so tipos fixos: compila tambem no PC (tools/, lib/hal)
+#include "amostragem.h" // so macros: taxa de saida da FIFO do MAX30102
 
 // Configurações
 #define MAXVALUES       150
 #define MAXVARDET       10
-#define SAMPLE_RATE     62.5f // Valor fixo desse projeto, calibrado para tal
+#define SAMPLE_RATE_MHZ MAX30102_PADRAO_TAXA_EFETIVA_MHZ // taxa / media do chip (62.5 Hz), em mHz
+#define SAMPLE_RATE     (SAMPLE_RATE_MHZ / 1000.0f)     // calibrado em 62.5 Hz
+
+// A versao float de detectarValesEBPM so e compilada como referencia fora do AVR,
+// onde nao puxa as rotinas de soft-float da libgcc.
+#ifndef CALCMASTER_REFERENCIA_FLOAT
+#   if defined(__AVR__)
+#       define CALCMASTER_REFERENCIA_FLOAT 0
+#   else
+#       define CALCMASTER_REFERENCIA_FLOAT 1
+#   endif
+#endif
+
+// Configurações do detector incremental (em amostras, derivadas de SAMPLE_RATE_MHZ;
+// os comentarios dao o valor em 62.5 Hz)
+#define DETECTOR_MEDIA          4       // intervalos usados na media movel do BPM
+#define DETECTOR_AQUECIMENTO    ((uint16_t)(SAMPLE_RATE_MHZ * 1024UL / 1000000UL))  // 64: ~1 s para o limiar adaptativo
+#define DETECTOR_INTERVALO_MIN  ((uint16_t)(SAMPLE_RATE_MHZ * 60UL / 234000UL))     // 16: ~234 BPM
+#define DETECTOR_INTERVALO_MAX  ((uint16_t)(SAMPLE_RATE_MHZ * 60UL / 30000UL))      // 125: ~30 BPM
+
+// Configurações do SpO2
+#define SPO2_MEDIA              4       // batimentos usados na media do SpO2
+// Constante de tempo do DC: 2^SPO2_DC_SHIFT amostras, a potencia de 2 mais proxima de 1 s (6 em 62.5 Hz)
+#define SPO2_DC_SHIFT           (SAMPLE_RATE_MHZ <  11314UL ? 3 : \
+                                 SAMPLE_RATE_MHZ <  22627UL ? 4 : \
+                                 SAMPLE_RATE_MHZ <  45255UL ? 5 : \
+                                 SAMPLE_RATE_MHZ <  90510UL ? 6 : \
+                                 SAMPLE_RATE_MHZ < 181019UL ? 7 : \
+                                 SAMPLE_RATE_MHZ < 362039UL ? 8 : 9)
+// Curva empirica linear SpO2 = A - B * R, com A e B tabelados pela temperatura do
+// die do MAX30102 (o comprimento de onda do LED vermelho sobe ~0.13 nm/C). Tabela
+// em PROGMEM (calcMaster.cpp), um ponto a cada SPO2_CALIB_PASSO_C, interpolada.
+// Sem calibracao de bancada todos os pontos repetem o de 25 C; a inclinacao
+// estimada so entra com SPO2_CALIB_TEMPERATURA = 1.
+#ifndef SPO2_CALIB_TEMPERATURA
+#   define SPO2_CALIB_TEMPERATURA 0
+#endif
+#define SPO2_CALIB_TEMP_MIN_C   15      // primeiro ponto; abaixo dele vale o primeiro
+#define SPO2_CALIB_PASSO_C      5
+#define SPO2_CALIB_PONTOS       8       // 15 a 50 C; acima vale o ultimo
+#define SPO2_CALIB_TEMP_PADRAO_C 25     // ate a primeira conversao (A = 110.00, B = 25.00)
 
 //Tratamento de sinal
 uint32_t calcularTendencia(const uint32_t valores[3]);
 
 //Saida
 uint16_t mediaMaioresVariacoes(const uint32_t* dados, uint16_t tamanho, uint8_t qtdMaiores);
+uint16_t calcularBPMx100(uint32_t soma_intervalos, uint16_t total_intervalos);
+uint16_t detectarValesEBPMx100(const uint32_t* dados, uint16_t tamanho, uint16_t* indices_vales, uint8_t top_variacao);
+#if CALCMASTER_REFERENCIA_FLOAT
 float detectarValesEBPM(const uint32_t* dados, uint16_t tamanho, uint16_t* indices_vales, uint8_t top_variacao);
+#endif
+
+// -----------------------------------------------------------------------------
+// Detector incremental de vales: mesma ideia de detectarValesEBPM, mas O(1) por
+// amostra e sem buffer. O limiar (varMinima) acompanha as maiores variacoes
+// entre amostras com subida rapida e decaimento lento. Uma descida tambem precisa
+// de metade da queda media dos ultimos vales: a nota dicrotica, mais rasa, nao
+// conta como batimento.
+// -----------------------------------------------------------------------------
+class DetectorBatimento {
+public:
+    DetectorBatimento();
+
+    // Descarta o historico (ex.: dedo removido)
+    void reset();
+
+    // Amostras perdidas antes da proxima: nenhum intervalo atravessa a lacuna.
+    // Limiar e media dos intervalos ja medidos sao mantidos; a queda media recomeca.
+    void lacuna();
+
+    // Entrega uma nova amostra. Retorna o intervalo, em amostras, entre o vale
+    // confirmado agora e o anterior, ou 0 quando nenhum batimento foi confirmado.
+    uint16_t push(uint32_t amostra);
+
+    // O ultimo push confirmou um vale, mesmo que o intervalo tenha sido rejeitado
+    // (aquecimento, primeiro vale, fora de DETECTOR_INTERVALO_MIN/MAX)
+    bool vale() const { return _valeAgora; }
+
+    // BPM x 100 medio dos ultimos DETECTOR_MEDIA intervalos validos (0 se nao houver)
+    uint16_t bpmX100() const;
+
+    // Variacao minima atual usada para validar vales
+    uint32_t limiar() const { return _limiarQ4 >> 4; }
+
+private:
+    enum Estado : uint8_t {
+        SUBINDO,        // procurando o inicio de uma descida
+        DESCENDO,       // acompanhando a descida ate o fundo
+        CONFIRMANDO     // esperando a subida minima para confirmar o vale
+    };
+
+    uint32_t _anterior;         // amostra anterior
+    uint32_t _inicioDescida;    // valor no topo, antes da descida
+    uint32_t _menorValor;       // fundo do vale candidato
+    uint32_t _limiarQ4;         // varMinima adaptativa (Q4)
+    uint32_t _profundidade;     // media das quedas dos ultimos vales confirmados
+    uint16_t _idadeVale;        // amostras desde o fundo do vale candidato
+    uint16_t _desdeUltimoVale;  // amostras desde o ultimo vale confirmado
+    uint16_t _aquecimento;      // amostras restantes de estabilizacao
+    uint16_t _intervalos[DETECTOR_MEDIA];
+    uint16_t _somaIntervalos;
+    uint8_t  _indiceIntervalo;
+    uint8_t  _totalIntervalos;
+    Estado   _estado;
+    bool     _temAnterior;
+    bool     _temVale;
+    bool     _valeAgora;        // vale confirmado no ultimo push
+};
+
+// -----------------------------------------------------------------------------
+// Calculo de SpO2 por batimento, no mesmo passo do detector: DC de cada canal
+// por filtro passa-baixas (Q8) e AC pelo pico-a-pico entre dois vales.
+// R = (ACred / DCred) / (ACir / DCir) em Q8, SpO2 = A - B * R, tudo inteiro.
+// -----------------------------------------------------------------------------
+class CalculadoraSpO2 {
+public:
+    CalculadoraSpO2();
+
+    // Descarta o historico (ex.: dedo removido). A janela aberta agora nao
+    // comeca num vale: o primeiro batimento() depois do reset e descartado.
+    void reset();
+
+    // Entrega um par de amostras RED/IR na mesma taxa do detector
+    void push(uint32_t red, uint32_t ir);
+
+    // Amostras perdidas: o batimento em andamento e descartado no proximo
+    // batimento(). O DC segue de onde estava.
+    void lacuna() { _descartar = true; }
+
+    // Ganho do sensor mudou: como lacuna, e o DC recomeca na proxima amostra
+    void degrau() { _descartar = true; _temDc = false; }
+
+    // Fecha o batimento atual (chamar a cada vale confirmado pelo detector).
+    // valido = false quando o detector rejeitou o intervalo: a janela fecha sem
+    // virar SpO2. Retorna o SpO2 x 100 do batimento, ou 0 se nao for valido.
+    uint16_t batimento(bool valido = true);
+
+    // SpO2 x 100 medio dos ultimos SPO2_MEDIA batimentos validos (0 se nao houver)
+    uint16_t spo2X100() const;
+
+    // Ultima razao R calculada (Q8)
+    uint16_t razaoQ8() const { return _razaoQ8; }
+
+    // Pico-a-pico de IR do ultimo batimento fechado, em contagens
+    uint32_t acIr() const { return _acIr; }
+
+    // Temperatura do die em 1/16 C (Q4): escolhe A e B da curva na tabela.
+    // Continua valendo depois de reset().
+    void temperatura(int16_t tempQ4);
+
+    uint16_t coefAx100() const { return _coefAx100; }
+    uint16_t coefBx100() const { return _coefBx100; }
+
+private:
+    uint32_t _dcRedQ8;
+    uint32_t _dcIrQ8;
+    uint32_t _minRed;
+    uint32_t _maxRed;
+    uint32_t _minIr;
+    uint32_t _maxIr;
+    uint32_t _acIr;
+    uint16_t _valores[SPO2_MEDIA];
+    uint16_t _razaoQ8;
+    uint16_t _coefAx100;
+    uint16_t _coefBx100;
+    uint8_t  _indice;
+    uint8_t  _total;
+    bool     _temDc;
+    bool     _descartar;        // batimento atual atravessa uma lacuna
+};
+
+#endif // CALCMASTER_H
@@ -8,32 +8,24 @@
 //!
 
 #include "calcMaster.h"
+#include "../perf/perf.h"
+
+#if defined(__AVR__)
+#   include <avr/pgmspace.h>
+#else
+#   define PROGMEM
+#   define pgm_read_word(p) (*(const uint16_t*)(p))
+#endif
 
 // -----------------------------------------------------------------------------
 // Função auxiliar: calcula tendência com base em três valores consecutivos
 // -----------------------------------------------------------------------------
 
+// Todos os caminhos da versao original (comparacao dos sentidos a->b e b->c)
+// devolviam c: a "tendencia" e a amostra mais nova. Mantida para as variantes
+// em lote; o fluxo incremental usa os estagios de filtros.h.
 uint32_t calcularTendencia(const uint32_t valores[3]) {
-    uint32_t a = valores[0];
-    uint32_t b = valores[1];
-    uint32_t c = valores[2];
-
-    int8_t ab = (b > a) ? 1 : (b < a) ? -1 : 0;
-    int8_t bc = (c > b) ? 1 : (c < b) ? -1 : 0;
-
-    if (ab == bc && ab != 0) {
-        return c;
-    }
-
-    if (ab != 0 && bc != 0 && ab != bc) {
-        return (bc == ab) ? b : c;
-    }
-
-    if (ab == 0 && bc == 0) return c;
-    if (ab == 0) return c;
-    if (bc == 0) return c;
-
-    return c;
+    return valores[2];
 }
 
 // -----------------------------------------------------------------------------
@@ -94,13 +86,24 @@ uint16_t mediaMaioresVariacoes(const uint32_t* dados, uint16_t tamanho, uint8_t
 }
 
 // -----------------------------------------------------------------------------
-// Função principal: detecta vales e calcula BPM
+// Função auxiliar: converte intervalos (em amostras) em BPM x 100 sem float
 // -----------------------------------------------------------------------------
-float detectarValesEBPM(const uint32_t* dados, uint16_t tamanho, uint16_t* indices_vales, uint8_t top_variacao) {
-    if (tamanho < 3) return 0.0f;
+uint16_t calcularBPMx100(uint32_t soma_intervalos, uint16_t total_intervalos) {
+    if (soma_intervalos == 0 || total_intervalos == 0) return 0;
+
+    // BPM = 60 * fs * n / soma  ->  BPM x 100 = 6 * fs[mHz] * n / soma
+    const uint32_t bpm_x100 = (6UL * SAMPLE_RATE_MHZ * total_intervalos) / soma_intervalos;
+    return (bpm_x100 > 0xFFFF) ? 0xFFFF : (uint16_t)bpm_x100;
+}
+
+// -----------------------------------------------------------------------------
+// Função auxiliar: detecta vales e retorna a quantidade encontrada
+// -----------------------------------------------------------------------------
+static uint8_t detectarVales(const uint32_t* dados, uint16_t tamanho, uint16_t* indices_vales, uint8_t top_variacao) {
+    if (tamanho < 3) return 0;
 
     const uint16_t varMinima = mediaMaioresVariacoes(dados, tamanho, top_variacao);
-    if (varMinima == 0) return 0.0f;
+    if (varMinima == 0) return 0;
 
     uint8_t total_vales = 0;
     uint16_t i = 1;
@@ -169,7 +172,37 @@ float detectarValesEBPM(const uint32_t* dados, uint16_t tamanho, uint16_t* indic
         }
     }
 
-    if (total_vales < 2) return 0.0f;
+    return total_vales;
+}
+
+// -----------------------------------------------------------------------------
+// Função principal: detecta vales e calcula BPM x 100 (aritmetica inteira)
+// -----------------------------------------------------------------------------
+uint16_t detectarValesEBPMx100(const uint32_t* dados, uint16_t tamanho, uint16_t* indices_vales, uint8_t top_variacao) {
+    PERF_BEGIN(PERF_DETECTAR_VALES_X100);
+    const uint8_t total_vales = detectarVales(dados, tamanho, indices_vales, top_variacao);
+    uint16_t bpm_x100 = 0;
+
+    if (total_vales >= 2) {
+        // A soma dos intervalos entre vales consecutivos e telescopica
+        const uint16_t soma_intervalos = indices_vales[total_vales - 1] - indices_vales[0];
+        bpm_x100 = calcularBPMx100(soma_intervalos, total_vales - 1);
+    }
+    PERF_END(PERF_DETECTAR_VALES_X100);
+    return bpm_x100;
+}
+
+#if CALCMASTER_REFERENCIA_FLOAT
+// -----------------------------------------------------------------------------
+// Referência em float: detecta vales e calcula BPM
+// -----------------------------------------------------------------------------
+float detectarValesEBPM(const uint32_t* dados, uint16_t tamanho, uint16_t* indices_vales, uint8_t top_variacao) {
+    PERF_BEGIN(PERF_DETECTAR_VALES);
+    const uint8_t total_vales = detectarVales(dados, tamanho, indices_vales, top_variacao);
+    if (total_vales < 2) {
+        PERF_END(PERF_DETECTAR_VALES);
+        return 0.0f;
+    }
 
     // Cálculo do BPM otimizado
     float soma_intervalos = 0.0f;
@@ -193,5 +226,309 @@ float detectarValesEBPM(const uint32_t* dados, uint16_t tamanho, uint16_t* indic
     }
 
     const float media_intervalo = soma_intervalos / (total_vales - 1);
-    return (media_intervalo > 0.0f) ? (60.0f / media_intervalo) : 0.0f;
+    const float bpm = (media_intervalo > 0.0f) ? (60.0f / media_intervalo) : 0.0f;
+    PERF_END(PERF_DETECTAR_VALES);
+    return bpm;
+}
+#endif // CALCMASTER_REFERENCIA_FLOAT
+
+// -----------------------------------------------------------------------------
+// Detector incremental de vales e BPM
+// -----------------------------------------------------------------------------
+
+DetectorBatimento::DetectorBatimento() {
+    reset();
+}
+
+void DetectorBatimento::reset() {
+    _anterior        = 0;
+    _inicioDescida   = 0;
+    _menorValor      = 0;
+    _limiarQ4        = 0;
+    _profundidade    = 0;
+    _idadeVale       = 0;
+    _desdeUltimoVale = 0;
+    _aquecimento     = DETECTOR_AQUECIMENTO;
+    _somaIntervalos  = 0;
+    _indiceIntervalo = 0;
+    _totalIntervalos = 0;
+    _estado          = SUBINDO;
+    _temAnterior     = false;
+    _temVale         = false;
+    _valeAgora       = false;
+
+    for (uint8_t i = 0; i < DETECTOR_MEDIA; ++i) {
+        _intervalos[i] = 0;
+    }
+}
+
+void DetectorBatimento::lacuna() {
+    // Sem vale de referencia nem amostra anterior: a diferenca atraves da
+    // lacuna nao entra no limiar e o proximo vale so abre um novo intervalo.
+    // A amplitude pode ter mudado (degrau de ganho): a queda media recomeca.
+    _temAnterior  = false;
+    _temVale      = false;
+    _profundidade = 0;
+    _estado       = SUBINDO;
+}
+
+uint16_t DetectorBatimento::push(uint32_t amostra) {
+    _valeAgora = false;
+
+    if (!_temAnterior) {
+        _anterior = amostra;
+        _temAnterior = true;
+        return 0;
+    }
+
+    // Limiar adaptativo: equivalente incremental de mediaMaioresVariacoes,
+    // sobe rapido com variacoes grandes e decai ~1/64 por amostra
+    const uint32_t diff = (amostra > _anterior) ? (amostra - _anterior) : (_anterior - amostra);
+    const uint32_t diffQ4 = diff << 4;
+    if (diffQ4 > _limiarQ4) {
+        _limiarQ4 += (diffQ4 - _limiarQ4) >> 1;
+    } else {
+        _limiarQ4 -= _limiarQ4 >> 6;
+    }
+    const uint32_t varMinima = _limiarQ4 >> 4;
+
+    if (_aquecimento > 0) {
+        --_aquecimento;
+    }
+
+    // Sem vale de referencia por tempo demais: o proximo intervalo nao seria valido
+    if (_desdeUltimoVale < 0xFFFF) ++_desdeUltimoVale;
+    if (_idadeVale < 0xFFFF) ++_idadeVale;
+    if (_temVale && _desdeUltimoVale > DETECTOR_INTERVALO_MAX * 2) {
+        _temVale      = false;
+        _profundidade = 0;
+    }
+
+    uint16_t intervalo = 0;
+
+    switch (_estado) {
+    case SUBINDO:
+        // Verificação de vale: amostra atual < anterior
+        if (amostra < _anterior) {
+            _inicioDescida = _anterior;
+            _menorValor    = amostra;
+            _idadeVale     = 0;
+            _estado        = DESCENDO;
+        }
+        break;
+
+    case DESCENDO:
+        if (amostra < _menorValor) {
+            _menorValor = amostra;
+            _idadeVale  = 0;
+        } else if (amostra >= _anterior) {
+            // Fim da descida: verificar se a variação é significativa e se não é
+            // rasa demais perto dos ultimos vales (nota dicrotica)
+            const uint32_t queda = _inicioDescida - _menorValor;
+            if (queda >= varMinima && varMinima > 0 && queda >= (_profundidade >> 1)) {
+                _estado = CONFIRMANDO;
+            } else {
+                _estado = SUBINDO;
+                break;
+            }
+        } else {
+            break;
+        }
+        // A amostra que encerrou a descida ja pode confirmar o vale
+        // fallthrough
+
+    case CONFIRMANDO:
+        if (amostra < _menorValor) {
+            _menorValor = amostra;
+            _idadeVale  = 0;
+        } else if (amostra >= _menorValor + varMinima) {
+            // Vale confirmado _idadeVale amostras atras
+            if (_temVale && _aquecimento == 0) {
+                const uint16_t delta = _desdeUltimoVale - _idadeVale;
+                if (delta >= DETECTOR_INTERVALO_MIN && delta <= DETECTOR_INTERVALO_MAX) {
+                    _somaIntervalos -= _intervalos[_indiceIntervalo];
+                    _intervalos[_indiceIntervalo] = delta;
+                    _somaIntervalos += delta;
+                    _indiceIntervalo = (_indiceIntervalo + 1) % DETECTOR_MEDIA;
+                    if (_totalIntervalos < DETECTOR_MEDIA) ++_totalIntervalos;
+                    intervalo = delta;
+                }
+            }
+            // Queda media dos vales confirmados, 1/4 por vale (o primeiro vale entra inteiro)
+            const uint32_t profundidade = _inicioDescida - _menorValor;
+            if (_profundidade == 0) {
+                _profundidade = profundidade;
+            } else if (profundidade > _profundidade) {
+                _profundidade += (profundidade - _profundidade) >> 2;
+            } else {
+                _profundidade -= (_profundidade - profundidade) >> 2;
+            }
+            _temVale         = true;
+            _valeAgora       = true;
+            _desdeUltimoVale = _idadeVale;
+            _estado          = SUBINDO;
+        }
+        break;
+    }
+
+    _anterior = amostra;
+    return intervalo;
+}
+
+uint16_t DetectorBatimento::bpmX100() const {
+    return calcularBPMx100(_somaIntervalos, _totalIntervalos);
+}
+
+// -----------------------------------------------------------------------------
+// Calculo de SpO2 por batimento
+// -----------------------------------------------------------------------------
+
+// Razao AC/DC em Q16 sem estourar 32 bits (AC < 2^18, DC >= 16)
+static uint32_t razaoAcDcQ16(uint32_t ac, uint32_t dc) {
+    dc >>= 4;
+    if (dc == 0) return 0;
+    return (ac << 12) / dc;
+}
+
+// A e B (x100) por temperatura, de SPO2_CALIB_TEMP_MIN_C em SPO2_CALIB_PASSO_C.
+// Enquanto nao houver calibracao de bancada todos os pontos valem o de 25 C e a
+// temperatura nao muda o resultado. A tabela inclinada (SPO2_CALIB_TEMPERATURA)
+// gira em torno de R ~ 0.5: perto de 100% nada muda e em 85% o desvio e de
+// ~0.06% por grau; e uma estimativa, nao uma medida.
+typedef struct {
+    uint16_t aX100;
+    uint16_t bX100;
+} coefSpO2_t;
+
+static const coefSpO2_t CALIBRACAO_SPO2[SPO2_CALIB_PONTOS] PROGMEM = {
+#if SPO2_CALIB_TEMPERATURA
+    { 10940, 2380 },    // 15 C
+    { 10970, 2440 },    // 20 C
+    { 11000, 2500 },    // 25 C
+    { 11030, 2560 },    // 30 C
+    { 11060, 2620 },    // 35 C
+    { 11090, 2680 },    // 40 C
+    { 11120, 2740 },    // 45 C
+    { 11150, 2800 },    // 50 C
+#else
+    { 11000, 2500 },    // 15 C
+    { 11000, 2500 },    // 20 C
+    { 11000, 2500 },    // 25 C
+    { 11000, 2500 },    // 30 C
+    { 11000, 2500 },    // 35 C
+    { 11000, 2500 },    // 40 C
+    { 11000, 2500 },    // 45 C
+    { 11000, 2500 },    // 50 C
+#endif
+};
+
+// Interpolacao linear de um coeficiente entre dois pontos da tabela
+static uint16_t interpola(const uint16_t* p0, const uint16_t* p1, uint8_t resto) {
+    const int32_t c0 = pgm_read_word(p0);
+    const int32_t c1 = pgm_read_word(p1);
+    return (uint16_t)(c0 + (c1 - c0) * resto / (SPO2_CALIB_PASSO_C * 16));
+}
+
+CalculadoraSpO2::CalculadoraSpO2() {
+    reset();
+    temperatura(SPO2_CALIB_TEMP_PADRAO_C * 16);
+}
+
+void CalculadoraSpO2::temperatura(int16_t tempQ4) {
+    const int16_t fim = (SPO2_CALIB_PONTOS - 1) * SPO2_CALIB_PASSO_C * 16;
+    int16_t pos = tempQ4 - SPO2_CALIB_TEMP_MIN_C * 16;
+    if (pos < 0) pos = 0;
+    if (pos > fim) pos = fim;
+
+    const uint8_t i     = (uint8_t)(pos / (SPO2_CALIB_PASSO_C * 16));
+    const uint8_t resto = (uint8_t)(pos % (SPO2_CALIB_PASSO_C * 16));
+    const uint8_t j     = (resto != 0) ? i + 1 : i;
+
+    _coefAx100 = interpola(&CALIBRACAO_SPO2[i].aX100, &CALIBRACAO_SPO2[j].aX100, resto);
+    _coefBx100 = interpola(&CALIBRACAO_SPO2[i].bX100, &CALIBRACAO_SPO2[j].bX100, resto);
+}
+
+void CalculadoraSpO2::reset() {
+    _dcRedQ8 = 0;
+    _dcIrQ8  = 0;
+    _minRed  = 0xFFFFFFFF;
+    _maxRed  = 0;
+    _minIr   = 0xFFFFFFFF;
+    _maxIr   = 0;
+    _acIr    = 0;
+    _razaoQ8 = 0;
+    _indice  = 0;
+    _total   = 0;
+    _temDc   = false;
+    _descartar = true;      // a primeira janela nao comeca num vale
+
+    for (uint8_t i = 0; i < SPO2_MEDIA; ++i) {
+        _valores[i] = 0;
+    }
+}
+
+void CalculadoraSpO2::push(uint32_t red, uint32_t ir) {
+    // DC: passa-baixas de primeira ordem em Q8
+    if (!_temDc) {
+        _dcRedQ8 = red << 8;
+        _dcIrQ8  = ir << 8;
+        _temDc   = true;
+    } else {
+        _dcRedQ8 += (int32_t)((red << 8) - _dcRedQ8) >> SPO2_DC_SHIFT;
+        _dcIrQ8  += (int32_t)((ir << 8) - _dcIrQ8) >> SPO2_DC_SHIFT;
+    }
+
+    // AC: pico-a-pico dentro do batimento atual
+    if (red < _minRed) _minRed = red;
+    if (red > _maxRed) _maxRed = red;
+    if (ir < _minIr) _minIr = ir;
+    if (ir > _maxIr) _maxIr = ir;
+}
+
+uint16_t CalculadoraSpO2::batimento(bool valido) {
+    uint16_t spo2 = 0;
+
+    _acIr = (_maxIr > _minIr) ? _maxIr - _minIr : 0;
+
+    if (valido && !_descartar && _temDc && _maxRed > _minRed && _maxIr > _minIr) {
+        const uint32_t razaoRed = razaoAcDcQ16(_maxRed - _minRed, _dcRedQ8 >> 8);
+        const uint32_t razaoIr  = razaoAcDcQ16(_maxIr - _minIr, _dcIrQ8 >> 8);
+
+        if (razaoIr > 0) {
+            const uint32_t r = (razaoRed << 8) / razaoIr;
+            _razaoQ8 = (r > 0xFFFF) ? 0xFFFF : (uint16_t)r;
+
+            // SpO2 x 100 = A - B * R, limitado a [0, 100%]
+            const uint32_t desconto = ((uint32_t)_coefBx100 * _razaoQ8) >> 8;
+            if (desconto < _coefAx100) {
+                const uint32_t valor = _coefAx100 - desconto;
+                spo2 = (valor > 10000) ? 10000 : (uint16_t)valor;
+            }
+        }
+    }
+
+    if (spo2 > 0) {
+        _valores[_indice] = spo2;
+        _indice = (_indice + 1) % SPO2_MEDIA;
+        if (_total < SPO2_MEDIA) ++_total;
+    }
+
+    // Proximo batimento comeca do zero
+    _descartar = false;
+    _minRed = 0xFFFFFFFF;
+    _maxRed = 0;
+    _minIr  = 0xFFFFFFFF;
+    _maxIr  = 0;
+
+    return spo2;
+}
+
+uint16_t CalculadoraSpO2::spo2X100() const {
+    if (_total == 0) return 0;
+
+    uint32_t soma = 0;
+    for (uint8_t i = 0; i < _total; ++i) {
+        soma += _valores[i];
+    }
+    return soma / _total;
 }
@@ -0,0 +1,219 @@
+//!
+//! \file           filtros.h
+//! \brief          Estagios de filtro em ponto fixo para o sinal do MAX30102
+//! \author         Paulo Donizete Antunes Junior
+//! \date           2025-08-26
+//! \version        1.0
+//! \details        Todos os estagios tem a mesma interface:
+//!
+//!                     bool push(int32_t entrada, int32_t* saida);
+//!                     void reset();
+//!
+//!                 push devolve true quando *saida recebeu uma amostra nova (um
+//!                 estagio decimador ou uma janela enchendo devolve false).
+//!                 Cascata<A, B> liga dois estagios e e ela mesma um estagio, entao
+//!                 a cadeia inteira e um tipo montado em tempo de compilacao, com o
+//!                 tamanho conhecido e sem heap.
+//!
+//!                 So inteiros de 32 bits. Os coeficientes do biquad sao parametros
+//!                 do template: viram constantes, e o termo com coeficiente zero some.
+//!                 So cabecalho e sem dependencias: compila tambem no PC.
+//!
+
+#ifndef FILTROS_H
+#define FILTROS_H
+
+#include <stdint.h>
+
+// -----------------------------------------------------------------------------
+// Remocao de DC: y = x - DC, com o DC num passa-baixas de primeira ordem em Q8
+// (o mesmo de CalculadoraSpO2). Corte em fs / (2 pi 2^SHIFT): 0.155 Hz com
+// SHIFT = 6 em 62.5 Hz. O DC comeca na primeira amostra, sem degrau na saida.
+// Entrada de ate 2^22 (o ADC tem 18 bits).
+// -----------------------------------------------------------------------------
+template <uint8_t SHIFT>
+class FiltroDc {
+public:
+    FiltroDc() { reset(); }
+
+    void reset() {
+        _dcQ8  = 0;
+        _temDc = false;
+    }
+
+    bool push(int32_t entrada, int32_t* saida) {
+        if (!_temDc) {
+            _dcQ8  = entrada * 256;
+            _temDc = true;
+        } else {
+            _dcQ8 += (entrada * 256 - _dcQ8) >> SHIFT;
+        }
+        *saida = entrada - (_dcQ8 >> 8);
+        return true;
+    }
+
+private:
+    int32_t _dcQ8;
+    bool    _temDc;
+};
+
+// -----------------------------------------------------------------------------
+// Biquad (IIR de segunda ordem) na forma direta I, coeficientes em QQ:
+//     y = b0 x + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2]
+// O resto do deslocamento volta na amostra seguinte (realimentacao do erro):
+// sem vies de truncamento nem ciclo-limite em torno de zero. Entrada e saida
+// ficam em +-LIMITE, o que mantem o acumulador dentro de 32 bits.
+// -----------------------------------------------------------------------------
+template <int16_t B0, int16_t B1, int16_t B2, int16_t A1, int16_t A2, uint8_t Q>
+class Biquad {
+public:
+    static const int32_t LIMITE = (int32_t)1 << (29 - Q);
+
+    static_assert(((int32_t)(B0 < 0 ? -B0 : B0) + (B1 < 0 ? -B1 : B1) + (B2 < 0 ? -B2 : B2) +
+                   (A1 < 0 ? -A1 : A1) + (A2 < 0 ? -A2 : A2) + 1) * (int64_t)LIMITE < INT32_MAX,
+                  "coeficientes grandes demais para LIMITE: o acumulador estoura");
+
+    Biquad() { reset(); }
+
+    void reset() {
+        _x1 = _x2 = 0;
+        _y1 = _y2 = 0;
+        _resto = 0;
+    }
+
+    bool push(int32_t entrada, int32_t* saida) {
+        const int32_t x = limita(entrada);
+        int32_t acc = _resto;
+        acc += (int32_t)B0 * x;
+        if (B1 != 0) acc += (int32_t)B1 * _x1;
+        if (B2 != 0) acc += (int32_t)B2 * _x2;
+        acc -= (int32_t)A1 * _y1;
+        acc -= (int32_t)A2 * _y2;
+
+        const int32_t y = limita(acc >> Q);
+        _resto = acc - y * ((int32_t)1 << Q);
+        if (_resto < 0 || _resto >= ((int32_t)1 << Q)) {
+            _resto = 0;     // saturou: o erro nao cabe mais no resto
+        }
+
+        _x2 = _x1;
+        _x1 = x;
+        _y2 = _y1;
+        _y1 = y;
+        *saida = y;
+        return true;
+    }
+
+private:
+    static int32_t limita(int32_t v) {
+        return (v > LIMITE) ? LIMITE : (v < -LIMITE) ? -LIMITE : v;
+    }
+
+    int32_t _x1;
+    int32_t _x2;
+    int32_t _y1;
+    int32_t _y2;
+    int32_t _resto;
+};
+
+// Passa-faixa do pulso em 62.5 Hz: passa-altas em 0.3 Hz vezes passa-baixas em
+// 4 Hz, ambos de primeira ordem pela transformada bilinear. Numerador g (1 - z^-2),
+// polos reais em 0.9703 e 0.6614. -0.6 dB em 1.1 Hz, -1.4 dB em 0.5 Hz (30 BPM,
+// o limite do detector), -3 dB em 0.3 e 4 Hz, -7 dB em 8 Hz (nota dicrotica),
+// -80 dB em fs / 2. Coeficientes em Q12; outra taxa pede outros coeficientes.
+typedef Biquad<683, 0, -683, -6683, 2629, 12> PassaFaixaPulso;
+
+// -----------------------------------------------------------------------------
+// Media movel decimadora: soma fator amostras e entrega a media de cada grupo
+// (boxcar seguido de decimacao). O fator vem em tempo de execucao porque a
+// reproducao no PC o escolhe pela taxa da captura.
+// -----------------------------------------------------------------------------
+class MediaDecimada {
+public:
+    explicit MediaDecimada(uint8_t fator = 1) : _fator(fator ? fator : 1) { reset(); }
+
+    void reset() {
+        _soma     = 0;
+        _contagem = 0;
+    }
+
+    bool push(int32_t entrada, int32_t* saida) {
+        _soma += entrada;
+        if (++_contagem < _fator) {
+            return false;
+        }
+        *saida    = _soma / _fator;
+        _soma     = 0;
+        _contagem = 0;
+        return true;
+    }
+
+    uint8_t fator() const { return _fator; }
+
+private:
+    int32_t _soma;
+    uint8_t _fator;
+    uint8_t _contagem;
+};
+
+// -----------------------------------------------------------------------------
+// Mediana de 3: tira picos de uma amostra sem atrasar bordas largas (atraso de
+// uma amostra). As duas primeiras amostras so enchem a janela.
+// -----------------------------------------------------------------------------
+class Mediana3 {
+public:
+    Mediana3() { reset(); }
+
+    void reset() {
+        _a = _b = _c = 0;
+        _cheia = 0;
+    }
+
+    bool push(int32_t entrada, int32_t* saida) {
+        _a = _b;
+        _b = _c;
+        _c = entrada;
+        if (_cheia < 2) {
+            _cheia++;
+            return false;
+        }
+        // max(min(a, b), min(max(a, b), c))
+        const int32_t menor = (_a < _b) ? _a : _b;
+        const int32_t maior = (_a < _b) ? _b : _a;
+        const int32_t meio  = (maior < _c) ? maior : _c;
+        *saida = (menor > meio) ? menor : meio;
+        return true;
+    }
+
+private:
+    int32_t _a;
+    int32_t _b;
+    int32_t _c;
+    uint8_t _cheia;
+};
+
+// -----------------------------------------------------------------------------
+// Dois estagios em serie; B so roda quando A entrega amostra
+// -----------------------------------------------------------------------------
+template <class A, class B>
+class Cascata {
+public:
+    void reset() {
+        _a.reset();
+        _b.reset();
+    }
+
+    bool push(int32_t entrada, int32_t* saida) {
+        int32_t meio;
+        return _a.push(entrada, &meio) && _b.push(meio, saida);
+    }
+
+    A& primeiro() { return _a; }
+    B& segundo() { return _b; }
+
+private:
+    A _a;
+    B _b;
+};
+
+#endif // FILTROS_H
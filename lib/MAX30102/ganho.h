@@ -0,0 +1,72 @@
+//!
+//! \file           ganho.h
+//! \brief          Controle automatico de ganho do MAX30102 (corrente dos LEDs e faixa do ADC)
+//! \author         Paulo Donizete Antunes Junior
+//! \date           2025-08-24
+//! \version        1.0
+//! \details        Mantem o DC de cada canal dentro de uma faixa do ADC de 18 bits:
+//!                 acima de GANHO_DC_MAX (saturacao, luz ambiente forte) ou abaixo
+//!                 de GANHO_DC_MIN (pele escura, dedo frio) a corrente do LED e
+//!                 ajustada proporcionalmente para levar o DC ao alvo, no maximo
+//!                 2x por passo. Com o LED no limite, a faixa do ADC muda uma
+//!                 oitava. Dentro da faixa nada muda (histerese).
+//!
+//!                 Perfusao: se o AC de IR do ultimo batimento ficar abaixo de
+//!                 GANHO_AC_MIN, o piso e o alvo sobem para dar mais contagens
+//!                 ao pulso, sem passar de GANHO_DC_MAX.
+//!
+//!                 So decide: quem chama grava os registradores quando bloco()
+//!                 devolve mudancas. Nao toca em hardware, roda no PC.
+//!
+
+#ifndef GANHO_H
+#define GANHO_H
+
+#include <stdint.h>
+#include "amostragem.h"
+
+#define GANHO_FUNDO_ESCALA      262144UL    // 2^18 contagens
+#define GANHO_DC_MAX            (GANHO_FUNDO_ESCALA * 8 / 10)   // 80%: perto de saturar
+#define GANHO_DC_MIN            (GANHO_FUNDO_ESCALA * 2 / 10)   // 20%: AC perto do ruido
+#define GANHO_DC_ALVO           (GANHO_FUNDO_ESCALA * 5 / 10)
+#define GANHO_DC_ALVO_FRACO     (GANHO_FUNDO_ESCALA * 7 / 10)   // alvo com perfusao fraca
+#define GANHO_DC_AUSENTE        1000        // DC de IR abaixo disso: sem dedo, nada muda
+#define GANHO_AC_MIN            256         // pico-a-pico de IR minimo, em contagens
+#define GANHO_PA_MIN            0x04        // 0.8 mA
+#define GANHO_PA_MAX            0xFF        // 51 mA
+#define GANHO_FAIXA_MIN         2048        // nA
+#define GANHO_FAIXA_MAX         16384
+
+// Mascara devolvida por ControleGanho::bloco
+#define GANHO_MUDOU_RED         0x01
+#define GANHO_MUDOU_IR          0x02
+#define GANHO_MUDOU_FAIXA       0x04
+
+class ControleGanho {
+public:
+    ControleGanho();
+
+    // Volta a corrente e a faixa iniciais (MAX30102_PADRAO_*)
+    void reset();
+
+    // DC medio de um bloco da FIFO em cada canal. Devolve GANHO_MUDOU_* com os
+    // alvos que mudaram (0 = nada a gravar).
+    uint8_t bloco(uint32_t dcRed, uint32_t dcIr);
+
+    // Pico-a-pico de IR do ultimo batimento, avaliado no proximo bloco
+    void batimento(uint32_t acIr);
+
+    uint8_t  paRed() const { return _paRed; }
+    uint8_t  paIr() const { return _paIr; }
+    uint16_t faixaNa() const { return _faixaNa; }
+
+private:
+    uint8_t ajustaPa(uint8_t pa, uint32_t dc, uint32_t alvo) const;
+
+    uint16_t _faixaNa;
+    uint8_t  _paRed;
+    uint8_t  _paIr;
+    bool     _perfusaoFraca;
+};
+
+#endif // GANHO_H
@@ -0,0 +1,95 @@
+//!
+//! \file           ganho.cpp
+//! \brief          Controle automatico de ganho do MAX30102 (corrente dos LEDs e faixa do ADC)
+//! \author         Paulo Donizete Antunes Junior
+//! \date           2025-08-24
+//! \version        1.0
+//! \details        Ver ganho.h
+//!
+
+#include "ganho.h"
+
+ControleGanho::ControleGanho() {
+    reset();
+}
+
+void ControleGanho::reset() {
+    _faixaNa       = MAX30102_PADRAO_FAIXA_NA;
+    _paRed         = MAX30102_PADRAO_LED_PA;
+    _paIr          = MAX30102_PADRAO_LED_PA;
+    _perfusaoFraca = false;
+}
+
+// Corrente que leva dc ao alvo, supondo DC proporcional a corrente; no maximo
+// dobra ou divide por 2 em um passo
+uint8_t ControleGanho::ajustaPa(uint8_t pa, uint32_t dc, uint32_t alvo) const {
+    uint32_t novo = (dc > 0) ? (uint32_t)pa * alvo / dc : (uint32_t)pa * 2;
+
+    if (novo > (uint32_t)pa * 2) novo = (uint32_t)pa * 2;
+    if (novo < pa / 2) novo = pa / 2;
+    if (novo > GANHO_PA_MAX) novo = GANHO_PA_MAX;
+    if (novo < GANHO_PA_MIN) novo = GANHO_PA_MIN;
+    return (uint8_t)novo;
+}
+
+uint8_t ControleGanho::bloco(uint32_t dcRed, uint32_t dcIr) {
+    // Sem dedo nao ha o que regular: subir os LEDs so gastaria corrente
+    if (dcIr < GANHO_DC_AUSENTE) {
+        return 0;
+    }
+
+    const uint32_t piso = _perfusaoFraca ? GANHO_DC_ALVO : GANHO_DC_MIN;
+    const uint32_t alvo = _perfusaoFraca ? GANHO_DC_ALVO_FRACO : GANHO_DC_ALVO;
+    const uint32_t dc[2] = { dcRed, dcIr };
+    uint8_t pa[2] = { _paRed, _paIr };
+    bool sobeFaixa = false;
+    bool desceFaixa = true;     // so se os dois canais pedirem
+
+    for (uint8_t c = 0; c < 2; c++) {
+        const bool alto  = dc[c] > GANHO_DC_MAX;
+        const bool baixo = dc[c] < piso;
+
+        if (!baixo) {
+            desceFaixa = false;
+        }
+        if (!alto && !baixo) {
+            continue;           // dentro da faixa: histerese
+        }
+
+        const uint8_t novo = ajustaPa(pa[c], dc[c], alvo);
+        if (novo != pa[c]) {
+            pa[c] = novo;
+            desceFaixa = false;
+        } else if (alto) {
+            sobeFaixa = true;   // LED ja no minimo
+        }
+    }
+
+    // Faixa do ADC: uma oitava por passo e so com o LED no limite. Subir ganha de
+    // descer (saturacao perde o pulso inteiro); descer dobra as contagens, entao so
+    // se os dois canais couberem abaixo de GANHO_DC_MAX.
+    if (sobeFaixa && _faixaNa < GANHO_FAIXA_MAX) {
+        _faixaNa = (uint16_t)(_faixaNa * 2);
+        return GANHO_MUDOU_FAIXA;
+    }
+    if (desceFaixa && !sobeFaixa && _faixaNa > GANHO_FAIXA_MIN &&
+        dcRed * 2 < GANHO_DC_MAX && dcIr * 2 < GANHO_DC_MAX) {
+        _faixaNa = (uint16_t)(_faixaNa / 2);
+        return GANHO_MUDOU_FAIXA;
+    }
+
+    uint8_t mudou = 0;
+    if (pa[0] != _paRed) {
+        _paRed = pa[0];
+        mudou |= GANHO_MUDOU_RED;
+    }
+    if (pa[1] != _paIr) {
+        _paIr = pa[1];
+        mudou |= GANHO_MUDOU_IR;
+    }
+    return mudou;
+}
+
+void ControleGanho::batimento(uint32_t acIr) {
+    _perfusaoFraca = (acIr < GANHO_AC_MIN);
+}
@@ -0,0 +1,79 @@
+//!
+//! \file           oximetro.h
+//! \brief          Cadeia de processamento do oximetro, da amostra crua ao BPM/SpO2
+//! \author         Paulo Donizete Antunes Junior
+//! \date           2025-08-14
+//! \version        1.0
+//! \details        Media opcional de 'decimacao' amostras e, no IR, mediana de 3,
+//!                 remocao de DC e passa-faixa de 0.3 a 4 Hz (filtros.h) antes do
+//!                 DetectorBatimento; CalculadoraSpO2 usa RED e IR sem filtro (precisa
+//!                 do DC). So recebe amostras com dedo:
+//!                 a presenca e decidida antes, por bloco (presenca.h). Nao toca em
+//!                 registradores: roda igual no AVR e no PC (tools/replay).
+//!
+
+#ifndef OXIMETRO_H
+#define OXIMETRO_H
+
+#include <stdint.h>
+#include "calcMaster.h"
+#include "filtros.h"
+
+#define OXIMETRO_DECIMACAO      1       // o MAX30102 ja entrega SAMPLE_RATE (media no chip)
+#define OXIMETRO_DC_SHIFT       6       // remocao de DC antes do passa-faixa (0.155 Hz)
+
+static_assert(SAMPLE_RATE_MHZ == 62500UL,
+              "PassaFaixaPulso (filtros.h) foi projetado para 62.5 Hz");
+
+// IR ate o detector: mediana de 3 (picos de uma amostra), DC fora (o passa-faixa
+// em ponto fixo so aceita +-LIMITE) e passa-faixa do pulso
+typedef Cascata<Mediana3, Cascata<FiltroDc<OXIMETRO_DC_SHIFT>, PassaFaixaPulso> > CadeiaPulso;
+
+// Eventos devolvidos por Oximetro::push (mascara de bits)
+#define OXIMETRO_TENDENCIA      0x01    // nova amostra filtrada em tendencia() (62.5 Hz)
+#define OXIMETRO_BATIMENTO      0x04    // vale confirmado: bpmX100() e spo2X100() atualizados
+
+class Oximetro {
+public:
+    // decimacao > 1 tira a media em software de amostras numa taxa maior que
+    // SAMPLE_RATE (ex.: capturas antigas de 1000 sps: 16)
+    explicit Oximetro(uint8_t decimacao = OXIMETRO_DECIMACAO);
+
+    // Descarta medias parciais, estado dos filtros e historico do detector/SpO2
+    void reset();
+
+    // Marca amostras perdidas antes da proxima (rollover da FIFO): descarta a
+    // media parcial, o estado dos filtros e os batimentos que atravessam a
+    // lacuna, mantendo BPM e SpO2 ja medidos
+    void lacuna();
+
+    // Corrente dos LEDs ou faixa do ADC mudou: como lacuna, e o DC do SpO2
+    // recomeca no novo nivel
+    void degrau();
+
+    // Temperatura do die do MAX30102 em 1/16 C: recalibra a curva do SpO2
+    void temperatura(int16_t tempQ4);
+
+    // Entrega uma amostra da FIFO. Retorna os eventos OXIMETRO_* gerados.
+    uint8_t push(uint32_t red, uint32_t ir);
+
+    // IR filtrado, centrado em zero (vale = sistole)
+    int32_t  tendencia() const { return _saida; }
+    uint16_t bpmX100() const { return _bpmX100; }
+    uint16_t spo2X100() const { return _spo2X100; }
+
+    const DetectorBatimento& detector() const { return _detector; }
+    const CalculadoraSpO2& spo2() const { return _spo2; }
+
+private:
+    DetectorBatimento _detector;
+    CalculadoraSpO2   _spo2;
+    MediaDecimada     _mediaIr;
+    MediaDecimada     _mediaRed;
+    CadeiaPulso       _pulso;
+    int32_t  _saida;            // ultima saida de _pulso
+    uint16_t _bpmX100;
+    uint16_t _spo2X100;
+};
+
+#endif // OXIMETRO_H
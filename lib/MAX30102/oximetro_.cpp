@@ -0,0 +1,81 @@
+//!
+//! \file           oximetro.cpp
+//! \brief          Cadeia de processamento do oximetro, da amostra crua ao BPM/SpO2
+//! \author         Paulo Donizete Antunes Junior
+//! \date           2025-08-14
+//! \version        1.0
+//! \details        Ver oximetro.h
+//!
+
+#include "oximetro.h"
+
+Oximetro::Oximetro(uint8_t decimacao) : _mediaIr(decimacao), _mediaRed(decimacao) {
+    reset();
+}
+
+void Oximetro::reset() {
+    _detector.reset();
+    _spo2.reset();
+    _mediaIr.reset();
+    _mediaRed.reset();
+    _pulso.reset();
+    _saida    = 0;
+    _bpmX100  = 0;
+    _spo2X100 = 0;
+}
+
+void Oximetro::lacuna() {
+    _detector.lacuna();
+    _spo2.lacuna();
+    _mediaIr.reset();
+    _mediaRed.reset();
+    _pulso.reset();
+}
+
+void Oximetro::degrau() {
+    lacuna();
+    _spo2.degrau();
+}
+
+void Oximetro::temperatura(int16_t tempQ4) {
+    _spo2.temperatura(tempQ4);
+}
+
+uint8_t Oximetro::push(uint32_t red, uint32_t ir) {
+    // Media em software so para fontes acima de SAMPLE_RATE (fator 1: passa
+    // direto); a soma continua entre drenagens da FIFO
+    int32_t irMedia  = 0;
+    int32_t redMedia = 0;
+    _mediaRed.push((int32_t)red, &redMedia);
+    if (!_mediaIr.push((int32_t)ir, &irMedia)) {
+        return 0;
+    }
+
+    // Mediana, DC e passa-faixa; as duas primeiras amostras enchem a mediana
+    if (!_pulso.push(irMedia, &_saida)) {
+        return 0;
+    }
+
+    // AC/DC de RED e IR acompanham o mesmo fluxo do detector (sem varrer buffer)
+    _spo2.push((uint32_t)redMedia, (uint32_t)irMedia);
+
+    // O detector trabalha com amostras sem sinal: o pulso vai de 0 a 2 * LIMITE
+    const uint16_t intervalo = _detector.push((uint32_t)(_saida + PassaFaixaPulso::LIMITE));
+    if (!_detector.vale()) {
+        return OXIMETRO_TENDENCIA;
+    }
+
+    // Todo vale confirmado fecha a janela do SpO2; sem isso o AC do proximo
+    // batimento cobriria dois ou mais pulsos. A janela que termina num intervalo
+    // rejeitado pelo detector e descartada.
+    if (intervalo == 0) {
+        _spo2.batimento(false);
+        return OXIMETRO_TENDENCIA;
+    }
+
+    _bpmX100 = _detector.bpmX100();
+    _spo2.batimento();
+    _spo2X100 = _spo2.spo2X100();
+
+    return OXIMETRO_TENDENCIA | OXIMETRO_BATIMENTO;
+}
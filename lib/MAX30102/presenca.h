@@ -0,0 +1,63 @@
+//!
+//! \file           presenca.h
+//! \brief          Maquina de estados de presenca do dedo sobre o MAX30102
+//! \author         Paulo Donizete Antunes Junior
+//! \date           2025-08-25
+//! \version        1.0
+//! \details        Sem dedo o MAX30102 fica no modo de proximidade: so o LED IR
+//!                 pisca com a corrente piloto (PILOT_PA), a FIFO nao recebe
+//!                 amostras e o AVR dorme. Quando o IR passa de PROX_INT_THRESH o
+//!                 chip levanta PROX_INT e entra sozinho na aquisicao completa.
+//!
+//!                 AUSENTE --PROX_INT--> CONFIRMANDO --bloco >= ENTRADA--> PRESENTE
+//!                 CONFIRMANDO --bloco < ENTRADA--> AUSENTE (rearma a proximidade)
+//!                 PRESENTE --bloco < SAIDA--> AUSENTE (rearma a proximidade)
+//!
+//!                 A decisao usa a menor amostra de IR de cada bloco da FIFO: o
+//!                 bloco em que o dedo sai ja nao chega ao DSP. ENTRADA > SAIDA
+//!                 da a histerese. Sem PROX_INT (reproducao no PC) um bloco acima
+//!                 de ENTRADA tambem leva de AUSENTE a PRESENTE.
+//!
+//!                 So decide: nao toca em hardware, roda no PC.
+//!
+
+#ifndef PRESENCA_H
+#define PRESENCA_H
+
+#include <stdint.h>
+
+#define PRESENCA_ENTRADA        5000    // menor IR do bloco para confirmar o dedo
+#define PRESENCA_SAIDA          4000    // menor IR do bloco abaixo disso: dedo saiu
+                                        // (PILOT_PA e PROX_INT_THRESH em amostragem.h)
+
+// Eventos devolvidos por DetectorPresenca (mascara de bits)
+#define PRESENCA_CHEGOU         0x01    // dedo confirmado: zerar o historico do DSP
+#define PRESENCA_SAIU           0x02    // dedo removido: zerar medidas e ganho
+#define PRESENCA_REARMA         0x04    // voltar o sensor ao modo de proximidade
+
+typedef enum : uint8_t {
+    PRESENCA_AUSENTE,
+    PRESENCA_CONFIRMANDO,
+    PRESENCA_PRESENTE
+} presencaEstado_t;
+
+class DetectorPresenca {
+public:
+    DetectorPresenca() { reset(); }
+
+    void reset() { _estado = PRESENCA_AUSENTE; }
+
+    // PROX_INT: o chip detectou algo e ja esta na aquisicao completa
+    void proximidade();
+
+    // Menor amostra de IR de um bloco da FIFO. Devolve os eventos PRESENCA_*.
+    uint8_t bloco(uint32_t menorIr);
+
+    presencaEstado_t estado() const { return _estado; }
+    bool presente() const { return _estado == PRESENCA_PRESENTE; }
+
+private:
+    presencaEstado_t _estado;
+};
+
+#endif // PRESENCA_H
@@ -0,0 +1,38 @@
+//!
+//! \file           presenca.cpp
+//! \brief          Maquina de estados de presenca do dedo sobre o MAX30102
+//! \author         Paulo Donizete Antunes Junior
+//! \date           2025-08-25
+//! \version        1.0
+//! \details        Ver presenca.h
+//!
+
+#include "presenca.h"
+
+void DetectorPresenca::proximidade() {
+    if (_estado == PRESENCA_AUSENTE) {
+        _estado = PRESENCA_CONFIRMANDO;
+    }
+}
+
+uint8_t DetectorPresenca::bloco(uint32_t menorIr) {
+    switch (_estado) {
+    case PRESENCA_AUSENTE:
+    case PRESENCA_CONFIRMANDO:
+        if (menorIr >= PRESENCA_ENTRADA) {
+            _estado = PRESENCA_PRESENTE;
+            return PRESENCA_CHEGOU;
+        }
+        // Disparo falso (reflexo, dedo passando) ou bloco velho: volta a esperar
+        _estado = PRESENCA_AUSENTE;
+        return PRESENCA_REARMA;
+
+    case PRESENCA_PRESENTE:
+        if (menorIr < PRESENCA_SAIDA) {
+            _estado = PRESENCA_AUSENTE;
+            return PRESENCA_SAIU | PRESENCA_REARMA;
+        }
+        break;
+    }
+    return 0;
+}
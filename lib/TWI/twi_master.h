@@ -9,8 +9,15 @@
 #ifndef TWI_MASTER_H_
 #define TWI_MASTER_H_
 
+#if defined(__AVR__)
 #include <avr/io.h>
 #include <util/twi.h>
+#else
+/* Host builds (lib/hal Linux backend, tools/) only use the types and constants */
+#include <stdint.h>
+#define TW_WRITE			0
+#define TW_READ				1
+#endif
 #include <stdbool.h>
 
 #define DEBUG_LOG			0
@@ -24,6 +31,28 @@
 #define TW_READ_ACK			1
 #define TW_READ_NACK		0
 
+/* Number of transactions that can wait for the bus at once */
+#ifndef TW_QUEUE_SIZE
+#define TW_QUEUE_SIZE		4
+#endif
+
+/* Default transaction timeout, in tw_tick() calls (0.5 ms each in this project) */
+#ifndef TW_TIMEOUT_TICKS
+#define TW_TIMEOUT_TICKS	20
+#endif
+
+/* Timeout used by tw_wait() while global interrupts are off (no tick source) */
+#ifndef TW_POLL_TIMEOUT
+#define TW_POLL_TIMEOUT		20000UL
+#endif
+
+/* Driver errors live above the 8-bit TW_STATUS range */
+#define TW_ERR_QUEUE_FULL	0x0100
+#define TW_ERR_TIMEOUT		0x0101	/* no completion in time, bus was recovered */
+#define TW_ERR_ADDR_NACK	0x0102	/* SLA+W/SLA+R not acknowledged */
+#define TW_ERR_DATA_NACK	0x0103	/* data byte not acknowledged */
+#define TW_ERR_BUS			0x0104	/* illegal START/STOP, bus was recovered */
+
 typedef uint16_t ret_code_t;
 
 typedef enum {
@@ -32,7 +61,49 @@ typedef enum {
 	TW_FREQ_400K
 } twi_freq_mode_t;
 
+typedef enum {
+	TW_XFER_WRITE,			/* START, SLA+W, wr bytes */
+	TW_XFER_READ,			/* START, SLA+R, rd bytes */
+	TW_XFER_WRITE_READ		/* START, SLA+W, wr bytes, REPEATED START, SLA+R, rd bytes */
+} tw_xfer_type_t;
+
+typedef struct tw_xfer tw_xfer_t;
+typedef void (*tw_callback_t)(tw_xfer_t* p_xfer);
+
+/*
+* Transaction descriptor. It is owned by the caller and must stay valid
+* until done is set. Read transfers need rd_len >= 1.
+*/
+struct tw_xfer {
+	uint8_t				addr;		/* 7-bit slave address */
+	tw_xfer_type_t		type;
+	const uint8_t*		p_wr;
+	uint8_t				wr_len;
+	uint8_t*			p_rd;
+	uint8_t				rd_len;
+	bool				no_stop;	/* keep the bus and let the next transfer send a REPEATED START */
+	tw_callback_t		callback;	/* called from TWI_vect on completion, may be NULL */
+	void*				p_ctx;		/* free for the callback owner */
+	uint8_t				timeout;	/* in tw_tick() calls, 0 selects TW_TIMEOUT_TICKS */
+	volatile bool		done;
+	volatile ret_code_t	status;		/* SUCCESS, TW_ERR_* or the TW_STATUS that stopped the transfer */
+};
+
 void tw_init(twi_freq_mode_t twi_freq, bool pullup_en);
+
+/* Non-blocking engine driven by TWI_vect */
+ret_code_t tw_submit(tw_xfer_t* p_xfer);
+bool tw_busy(void);
+void tw_poll(void);
+ret_code_t tw_wait(tw_xfer_t* p_xfer);
+
+/* Timeout time base, call it from a periodic interrupt */
+void tw_tick(void);
+
+/* Clocks SCL until a stuck slave frees SDA, sends STOP and re-runs tw_init */
+void tw_bus_recover(void);
+
+/* Blocking wrappers over tw_submit/tw_wait */
 ret_code_t tw_master_transmit(uint8_t slave_addr, uint8_t* p_data, uint8_t len, bool repeat_start);
 ret_code_t tw_master_receive(uint8_t slave_addr, uint8_t* p_data, uint8_t len);
 
@@ -7,125 +7,328 @@
 
 #include "twi_master.h"
 
-static ret_code_t tw_start(void)
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include <util/delay.h>
+
+/* Control words written to TWCR by the engine */
+#define TW_CR_NEXT			((1 << TWINT) | (1 << TWEN) | (1 << TWIE))
+#define TW_CR_ACK			(TW_CR_NEXT | (1 << TWEA))
+#define TW_CR_START			(TW_CR_NEXT | (1 << TWSTA))
+#define TW_CR_STOP			((1 << TWINT) | (1 << TWEN) | (1 << TWSTO))
+
+/* Iterations allowed for a pending STOP to leave the bus (a few us normally) */
+#define TW_STOP_WAIT_LIMIT	1000
+
+/* Half period of the recovery clock, ~100 kHz */
+#define TW_RECOVER_HALF_US	5
+
+/* Queue of submitted transactions, the head is the one on the bus */
+static tw_xfer_t* volatile tw_queue[TW_QUEUE_SIZE];
+static volatile uint8_t tw_head = 0;
+static volatile uint8_t tw_count = 0;
+
+/* Progress of the head transaction */
+static volatile uint8_t tw_index = 0;
+static volatile bool tw_reading = false;
+static volatile bool tw_running = false;
+static volatile uint8_t tw_ticks_left = 0;
+
+/* Settings kept for tw_bus_recover */
+static twi_freq_mode_t tw_freq_mode = TW_FREQ_100K;
+static bool tw_pullup = false;
+
+
+static void tw_begin(tw_xfer_t* p_xfer, bool stop_pending)
 {
-	/* Send START condition */
+	tw_index = 0;
+	tw_reading = (p_xfer->type == TW_XFER_READ);
+	tw_running = true;
+	tw_ticks_left = p_xfer->timeout ? p_xfer->timeout : TW_TIMEOUT_TICKS;
+
+	/* A STOP+START pair is sent back to back by the hardware */
+	TWCR = stop_pending ? (TW_CR_START | (1 << TWSTO)) : TW_CR_START;
+}
+
+
+static void tw_finish(ret_code_t status)
+{
+	tw_xfer_t* p_xfer = tw_queue[tw_head];
+	bool hold = p_xfer->no_stop && (status == SUCCESS);
+
 #if DEBUG_LOG
-	printf(BG "Send START condition..." RESET);
+	if (status != SUCCESS)
+	{
+		printf(BG "TWI transfer to 0x%02X failed: 0x%02X\n" RESET, p_xfer->addr, status);
+	}
 #endif
-	TWCR =  (1 << TWINT) | (1 << TWEN) | (1 << TWSTA);
 
-	/* Wait for TWINT flag to set */
-	while (!(TWCR & (1 << TWINT)));
+	tw_head = (tw_head + 1) % TW_QUEUE_SIZE;
+	tw_count--;
 
-	/* Check error */
-	if (TW_STATUS != TW_START && TW_STATUS != TW_REP_START)
+	/*
+	* The callback runs while tw_running is still set, so a transfer it
+	* submits is only queued and goes out below without an idle gap.
+	*/
+	p_xfer->status = status;
+	p_xfer->done = true;
+	if (p_xfer->callback)
 	{
-#if DEBUG_LOG
-		printf("\n");
-#endif
-		return TW_STATUS;
+		p_xfer->callback(p_xfer);
 	}
 
-#if DEBUG_LOG
-	printf("SUCCESS\n");
-#endif
-	return SUCCESS;
+	if (tw_count > 0)
+	{
+		/* Next transfer starts right away (REPEATED START when holding the bus) */
+		tw_begin(tw_queue[tw_head], !hold);
+	}
+	else
+	{
+		tw_running = false;
+		if (hold)
+		{
+			/* TWINT stays set with SCL low until the next tw_submit */
+			TWCR = (1 << TWEN);
+		}
+		else
+		{
+			TWCR = TW_CR_STOP;
+		}
+	}
 }
 
 
-static void tw_stop(void)
+/* Drops the head transfer after the bus got stuck or corrupted */
+static void tw_abort(ret_code_t status)
 {
-	/* Send STOP condition */
-#if DEBUG_LOG
-	puts(BG "Send STOP condition." RESET);
-#endif
-	TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWSTO);
+	tw_bus_recover();
+	tw_finish(status);
 }
 
 
-static ret_code_t tw_write_sla(uint8_t sla)
+/* One state machine step, TWINT must be set */
+static void tw_step(void)
 {
-	/* Transmit slave address with read/write flag */
-#if DEBUG_LOG
-	printf(BG "Write SLA + R/W: 0x%02X..." RESET, sla);
-#endif
-	TWDR = sla;
-	TWCR = (1 << TWINT) | (1 << TWEN);
+	tw_xfer_t* p_xfer = tw_queue[tw_head];
+	uint8_t status = TW_STATUS;
 
-	/* Wait for TWINT flag to set */
-	while (!(TWCR & (1 << TWINT)));
-	if (TW_STATUS != TW_MT_SLA_ACK && TW_STATUS != TW_MR_SLA_ACK)
+	switch (status)
 	{
-#if DEBUG_LOG
-		printf("\n");
-#endif
-		return TW_STATUS;
+		case TW_START:
+		case TW_REP_START:
+		tw_index = 0;
+		TWDR = tw_reading ? TW_SLA_R(p_xfer->addr) : TW_SLA_W(p_xfer->addr);
+		TWCR = TW_CR_NEXT;
+		break;
+
+		case TW_MT_SLA_ACK:
+		case TW_MT_DATA_ACK:
+		if (tw_index < p_xfer->wr_len)
+		{
+			TWDR = p_xfer->p_wr[tw_index++];
+			TWCR = TW_CR_NEXT;
+		}
+		else if (p_xfer->type == TW_XFER_WRITE_READ)
+		{
+			tw_reading = true;
+			TWCR = TW_CR_START;
+		}
+		else
+		{
+			tw_finish(SUCCESS);
+		}
+		break;
+
+		case TW_MR_SLA_ACK:
+		/* ACK every byte but the last one */
+		TWCR = (p_xfer->rd_len > 1) ? TW_CR_ACK : TW_CR_NEXT;
+		break;
+
+		case TW_MR_DATA_ACK:
+		p_xfer->p_rd[tw_index++] = TWDR;
+		TWCR = (tw_index < p_xfer->rd_len - 1) ? TW_CR_ACK : TW_CR_NEXT;
+		break;
+
+		case TW_MR_DATA_NACK:
+		p_xfer->p_rd[tw_index] = TWDR;
+		tw_finish(SUCCESS);
+		break;
+
+		case TW_MT_ARB_LOST:
+		/* Retry the whole transfer once the bus is free */
+		tw_reading = (p_xfer->type == TW_XFER_READ);
+		TWCR = TW_CR_START;
+		break;
+
+		case TW_MT_SLA_NACK:
+		case TW_MR_SLA_NACK:
+		tw_finish(TW_ERR_ADDR_NACK);
+		break;
+
+		case TW_MT_DATA_NACK:
+		tw_finish(TW_ERR_DATA_NACK);
+		break;
+
+		case TW_BUS_ERROR:
+		tw_abort(TW_ERR_BUS);
+		break;
+
+		default:
+		/* Unexpected state: give up and release the bus */
+		tw_finish(status);
+		break;
 	}
+}
 
-#if DEBUG_LOG
-	printf("SUCCESS\n");
-#endif
-	return SUCCESS;
+
+ret_code_t tw_submit(tw_xfer_t* p_xfer)
+{
+	ret_code_t error_code = SUCCESS;
+
+	p_xfer->done = false;
+	p_xfer->status = SUCCESS;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+	{
+		if (tw_count >= TW_QUEUE_SIZE)
+		{
+			error_code = TW_ERR_QUEUE_FULL;
+		}
+		else
+		{
+			tw_queue[(tw_head + tw_count) % TW_QUEUE_SIZE] = p_xfer;
+			tw_count++;
+
+			if (!tw_running)
+			{
+				/* Wait for a STOP still being sent by a previous transfer */
+				uint16_t guard = TW_STOP_WAIT_LIMIT;
+				while ((TWCR & (1 << TWSTO)) && --guard);
+				if (guard == 0)
+				{
+					tw_bus_recover();
+				}
+				tw_begin(p_xfer, false);
+			}
+		}
+	}
+
+	return error_code;
 }
 
 
-static ret_code_t tw_write(uint8_t data)
+bool tw_busy(void)
 {
-	/* Transmit 1 byte*/
-#if DEBUG_LOG
-	printf(BG "Write data byte: 0x%02X..." RESET, data);
-#endif
-	TWDR = data;
-	TWCR = (1 << TWINT) | (1 << TWEN);
+	return tw_count > 0;
+}
 
-	/* Wait for TWINT flag to set */
-	while (!(TWCR & (1 << TWINT)));
-	if (TW_STATUS != TW_MT_DATA_ACK)
+
+void tw_poll(void)
+{
+	/* Advances the engine only while TWI_vect cannot run (global interrupts disabled) */
+	if (!(SREG & (1 << SREG_I)) && tw_running && (TWCR & (1 << TWINT)))
 	{
-#if DEBUG_LOG
-		printf("\n");
-#endif
-		return TW_STATUS;
+		tw_step();
 	}
+}
+
 
+ret_code_t tw_wait(tw_xfer_t* p_xfer)
+{
+	uint32_t spins = 0;
+
+	while (!p_xfer->done)
+	{
+		if (SREG & (1 << SREG_I))
+		{
+			/* tw_tick takes care of the timeout */
+			spins = 0;
+			continue;
+		}
+
+		tw_poll();
+		if (++spins >= TW_POLL_TIMEOUT)
+		{
+			spins = 0;
+			if (tw_running)
+			{
+				tw_abort(TW_ERR_TIMEOUT);
+			}
+		}
+	}
+
+	return p_xfer->status;
+}
+
+
+void tw_tick(void)
+{
+	/* Called with TWI_vect masked (from another ISR or atomically) */
+	if (tw_running && tw_ticks_left && --tw_ticks_left == 0)
+	{
 #if DEBUG_LOG
-	printf("SUCCESS\n");
+		puts(BG "TWI timeout, recovering bus." RESET);
 #endif
-	return SUCCESS;
+		tw_abort(TW_ERR_TIMEOUT);
+	}
 }
 
 
-static uint8_t tw_read(bool read_ack)
+static void tw_line_low(uint8_t pin)
 {
-	if (read_ack)
+	PORTC &= ~(1 << pin);
+	DDRC  |= (1 << pin);
+}
+
+
+static void tw_line_release(uint8_t pin)
+{
+	DDRC &= ~(1 << pin);
+	if (tw_pullup)
 	{
-		TWCR = (1 << TWINT) | (1 << TWEN) | (1 << TWEA);
-		while (!(TWCR & (1 << TWINT)));
-		if (TW_STATUS != TW_MR_DATA_ACK)
-		{
-			return TW_STATUS;
-		}
+		PORTC |= (1 << pin);
 	}
-	else
+}
+
+
+void tw_bus_recover(void)
+{
+	/* Take the pins back from the TWI module, both lines released (open drain) */
+	TWCR = 0;
+	tw_line_release(TW_SDA_PIN);
+	tw_line_release(TW_SCL_PIN);
+	_delay_us(TW_RECOVER_HALF_US);
+
+	/* Up to 9 clocks let a slave finish the byte it is driving on SDA */
+	for (uint8_t i = 0; i < 9 && !(PINC & (1 << TW_SDA_PIN)); ++i)
 	{
-		TWCR = (1 << TWINT) | (1 << TWEN);
-		while (!(TWCR & (1 << TWINT)));
-		if (TW_STATUS != TW_MR_DATA_NACK)
-		{
-			return TW_STATUS;
-		}
+		tw_line_low(TW_SCL_PIN);
+		_delay_us(TW_RECOVER_HALF_US);
+		tw_line_release(TW_SCL_PIN);
+		_delay_us(TW_RECOVER_HALF_US);
 	}
-	uint8_t data = TWDR;
+
+	/* STOP: SDA rises while SCL is high */
+	tw_line_low(TW_SCL_PIN);
+	tw_line_low(TW_SDA_PIN);
+	_delay_us(TW_RECOVER_HALF_US);
+	tw_line_release(TW_SCL_PIN);
+	_delay_us(TW_RECOVER_HALF_US);
+	tw_line_release(TW_SDA_PIN);
+	_delay_us(TW_RECOVER_HALF_US);
+
 #if DEBUG_LOG
-	printf(BG "Read data byte: 0x%02X\n" RESET, data);
+	puts(BG "TWI bus recovered." RESET);
 #endif
-	return data;
+	tw_init(tw_freq_mode, tw_pullup);
 }
 
 
 void tw_init(twi_freq_mode_t twi_freq_mode, bool pullup_en)
 {
+	tw_freq_mode = twi_freq_mode;
+	tw_pullup = pullup_en;
+
 	DDRC  |= (1 << TW_SDA_PIN) | (1 << TW_SCL_PIN);
 	if (pullup_en)
 	{
@@ -167,69 +370,43 @@ void tw_init(twi_freq_mode_t twi_freq_mode, bool pullup_en)
 
 ret_code_t tw_master_transmit(uint8_t slave_addr, uint8_t* p_data, uint8_t len, bool repeat_start)
 {
-	ret_code_t error_code;
+	tw_xfer_t xfer = {};
 
-	/* Send START condition */
-	error_code = tw_start();
-	if (error_code != SUCCESS)
-	{
-		return error_code;
-	}
-
-	/* Send slave address with WRITE flag */
-	error_code = tw_write_sla(TW_SLA_W(slave_addr));
-	if (error_code != SUCCESS)
-	{
-		return error_code;
-	}
-
-	/* Send data byte in single or burst mode */
-	for (int i = 0; i < len; ++i)
-	{
-		error_code = tw_write(p_data[i]);
-		if (error_code != SUCCESS)
-		{
-			return error_code;
-		}
-	}
+	xfer.addr = slave_addr;
+	xfer.type = TW_XFER_WRITE;
+	xfer.p_wr = p_data;
+	xfer.wr_len = len;
+	xfer.no_stop = repeat_start;
 
-	if (!repeat_start)
+	/* Queue full: let the pending transfers drain first */
+	while (tw_submit(&xfer) == TW_ERR_QUEUE_FULL)
 	{
-		/* Send STOP condition */
-		tw_stop();
+		tw_poll();
 	}
 
-	return SUCCESS;
+	return tw_wait(&xfer);
 }
 
 
 ret_code_t tw_master_receive(uint8_t slave_addr, uint8_t* p_data, uint8_t len)
 {
-	ret_code_t error_code;
+	tw_xfer_t xfer = {};
 
-	/* Send START condition */
-	error_code = tw_start();
-	if (error_code != SUCCESS)
-	{
-		return error_code;
-	}
+	xfer.addr = slave_addr;
+	xfer.type = TW_XFER_READ;
+	xfer.p_rd = p_data;
+	xfer.rd_len = len;
 
-	/* Write slave address with READ flag */
-	error_code = tw_write_sla(TW_SLA_R(slave_addr));
-	if (error_code != SUCCESS)
+	while (tw_submit(&xfer) == TW_ERR_QUEUE_FULL)
 	{
-		return error_code;
+		tw_poll();
 	}
 
-	/* Read single or multiple data byte and send ack */
-	for (int i = 0; i < len-1; ++i)
-	{
-		p_data[i] = tw_read(TW_READ_ACK);
-	}
-	p_data[len-1] = tw_read(TW_READ_NACK);
+	return tw_wait(&xfer);
+}
 
-	/* Send STOP condition */
-	tw_stop();
 
-	return SUCCESS;
+ISR(TWI_vect)
+{
+	tw_step();
 }
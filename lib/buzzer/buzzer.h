@@ -0,0 +1,50 @@
+//!
+//! \file           buzzer.h
+//! \brief          Sequenciador de bipes do buzzer em PC0 temporizado pelo Timer2
+//! \author         Paulo Donizete Antunes Junior
+//! \date           2025-08-22
+//! \version        1.0
+//! \details        O buzzer e ativo (oscilador proprio): basta manter PC0 em nivel
+//!                 alto. O Timer2 em CTC com prescaler de 1024 (64 us por contagem)
+//!                 so interrompe nas bordas do padrao, em trechos de ate 16.4 ms:
+//!                 um bipe de 100 ms custa 7 interrupcoes, contra 200 do tick de
+//!                 0.5 ms. Sem padrao tocando o Timer2 fica parado.
+//!
+//!                 Os pinos de saida do Timer2 nao servem aqui: OC2A (PB3) e o MOSI
+//!                 do display e OC2B (PD3) e o botao em INT1.
+//!
+//!                 Prioridade: um padrao de prioridade maior interrompe o atual, um
+//!                 de prioridade igual o substitui e um de prioridade menor e
+//!                 ignorado enquanto o atual toca.
+//!
+
+#ifndef BUZZER_H
+#define BUZZER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define BUZZER_PINO          PC0     // em PORTC
+#define BUZZER_TEMPO_MAX_MS  4000    // limite de ligadoMs/desligadoMs (16 bits de contagens)
+
+// Padrao de bipes, guardado em PROGMEM
+typedef struct {
+    uint8_t  bips;          // 0 = continuo, ate buzzer_para
+    uint8_t  prioridade;    // 1..255 (0 = silencio)
+    uint16_t ligadoMs;
+    uint16_t desligadoMs;
+} buzzer_padrao_t;
+
+// PC0 como saida em nivel baixo, Timer2 religado no PRR e parado
+void buzzer_init(void);
+
+// Toca um padrao em PROGMEM. false se um padrao de prioridade maior estiver tocando.
+bool buzzer_toca(const buzzer_padrao_t* padrao_P);
+
+// Para o padrao atual se a prioridade dele for menor ou igual a prioridade dada
+void buzzer_para(uint8_t prioridade);
+
+// Prioridade do padrao tocando (0 = silencio)
+uint8_t buzzer_prioridade(void);
+
+#endif // BUZZER_H
@@ -0,0 +1,129 @@
+//!
+//! \file           buzzer.cpp
+//! \brief          Sequenciador de bipes do buzzer em PC0 temporizado pelo Timer2
+//! \author         Paulo Donizete Antunes Junior
+//! \date           2025-08-22
+//! \version        1.0
+//! \details        Ver buzzer.h.
+//!
+
+#include "buzzer.h"
+#include "../funsape/funsapeLibGlobalDefines.hpp"
+#include "../funsape/peripheral/funsapeLibTimer2.hpp"
+
+#include <avr/pgmspace.h>
+#include <avr/power.h>
+#include <util/atomic.h>
+
+// Contagens de 64 us (F_CPU / 1024) para um tempo em ms, arredondado
+#define CONTAGENS(ms)   ((uint16_t)(((uint32_t)(ms) * (F_CPU / 1024UL) + 500) / 1000))
+
+// Maior trecho de uma interrupcao: OCR2A = 255
+#define TRECHO_MAX      256
+
+// Padrao tocando, ja convertido para contagens
+static uint16_t         contagensLigado;
+static uint16_t         contagensDesligado;
+static uint8_t          bipsPadrao;
+static volatile uint8_t prioridadeAtual = 0;
+
+static uint8_t          bipsRestantes;
+static bool             ligado;
+static uint16_t         restante;       // contagens ate a proxima borda, alem do trecho atual
+
+// Programa o proximo trecho (o CTC reinicia TCNT2 no compare match)
+static void agendaTrecho(void)
+{
+    uint16_t trecho = (restante > TRECHO_MAX) ? TRECHO_MAX : restante;
+    restante -= trecho;
+    timer2.setCompareAValue((uint8_t)(trecho - 1));
+}
+
+static void fase(bool liga)
+{
+    ligado = liga;
+    if (liga) {
+        setBit(PORTC, BUZZER_PINO);
+    } else {
+        clrBit(PORTC, BUZZER_PINO);
+    }
+    restante = liga ? contagensLigado : contagensDesligado;
+}
+
+// Com interrupcoes desligadas
+static void silencia(void)
+{
+    timer2.setClockSource(Timer2::ClockSource::DISABLED);
+    timer2.deactivateCompareAInterrupt();
+    clrBit(PORTC, BUZZER_PINO);
+    prioridadeAtual = 0;
+}
+
+void buzzer_init(void)
+{
+    power_timer2_enable();
+    setBit(DDRC, BUZZER_PINO);
+    clrBit(PORTC, BUZZER_PINO);
+    timer2.init(Timer2::Mode::CTC_OCRA, Timer2::ClockSource::DISABLED);
+}
+
+bool buzzer_toca(const buzzer_padrao_t* padrao_P)
+{
+    buzzer_padrao_t padrao;
+    memcpy_P(&padrao, padrao_P, sizeof(padrao));
+
+    if (padrao.ligadoMs > BUZZER_TEMPO_MAX_MS) padrao.ligadoMs = BUZZER_TEMPO_MAX_MS;
+    if (padrao.desligadoMs > BUZZER_TEMPO_MAX_MS) padrao.desligadoMs = BUZZER_TEMPO_MAX_MS;
+
+    // Conversao fora do ISR; uma fase de 0 ms ainda dura uma contagem
+    uint16_t ligadoC    = CONTAGENS(padrao.ligadoMs);
+    uint16_t desligadoC = CONTAGENS(padrao.desligadoMs);
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (padrao.prioridade < prioridadeAtual) {
+            return false;
+        }
+        silencia();
+
+        contagensLigado    = ligadoC ? ligadoC : 1;
+        contagensDesligado = desligadoC ? desligadoC : 1;
+        bipsPadrao         = padrao.bips;
+        bipsRestantes      = padrao.bips;
+        prioridadeAtual    = padrao.prioridade;
+
+        fase(true);
+        agendaTrecho();
+        timer2.setCounterValue(0);
+        timer2.clearCompareAInterruptRequest();
+        timer2.activateCompareAInterrupt();
+        timer2.setClockSource(Timer2::ClockSource::PRESCALER_1024);
+    }
+    return true;
+}
+
+void buzzer_para(uint8_t prioridade)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (prioridadeAtual != 0 && prioridadeAtual <= prioridade) {
+            silencia();
+        }
+    }
+}
+
+uint8_t buzzer_prioridade(void)
+{
+    return prioridadeAtual;
+}
+
+// Fim de um trecho: segue a fase atual ou passa para a proxima borda do padrao
+void timer2CompareACallback(void)
+{
+    if (restante == 0) {
+        if (ligado && bipsPadrao != 0 && --bipsRestantes == 0) {
+            silencia();
+            return;
+        }
+        fase(!ligado);
+    }
+    agendaTrecho();
+}
@@ -1059,7 +1059,7 @@ enum class Error : cuint16_t {
 
     // Buffer related error codes
     // BUFFER_EMPTY                                        = 0x0020,   //!< Buffer is empty
-    // BUFFER_FULL                                         = 0x0021,   //!< Buffer is full
+    BUFFER_FULL                                         = 0x0021,   //!< Buffer is full
     // BUFFER_NOT_ENOUGH_ELEMENTS                          = 0x0022,   //!< Not enough space in buffer to perform operation
     // BUFFER_NOT_ENOUGH_SPACE                             = 0x0023,   //!< Not enough space in buffer to perform operation
     // BUFFER_POINTER_NULL                                 = 0x0024,   //!< Buffer size was set to zero
@@ -10,8 +10,19 @@ FILE usartStream;
 
 int usartTransmitStdWrapper(char data, FILE *stream);
 
+static_assert((USART0_TX_BUFFER_SIZE & (USART0_TX_BUFFER_SIZE - 1)) == 0,
+        "USART0_TX_BUFFER_SIZE must be a power of two");
+static_assert(USART0_TX_BUFFER_SIZE <= 256,
+        "USART0_TX_BUFFER_SIZE must not exceed 256");
+
 Usart0::Usart0(BaudRate baudRate_p, Mode mode_p, FrameFormat format_p)
 {
+    // Transmission buffer and stdio handler
+    this->_txHead = 0;
+    this->_txCount = 0;
+    this->_txDropped = 0;
+    usartDefaultHandler = this;
+
     if(!this->setBaudRate(baudRate_p)) {
         // Returns error
         return;
@@ -287,6 +298,8 @@ bool_t Usart0::setBaudRate(const BaudRate baudRate_p)
     case Usart0::BaudRate::BAUD_RATE_128000:
     case Usart0::BaudRate::BAUD_RATE_230400:
     case Usart0::BaudRate::BAUD_RATE_256000:
+    case Usart0::BaudRate::BAUD_RATE_500000:
+    case Usart0::BaudRate::BAUD_RATE_1000000:
         break;
     default:
         // Returns error
@@ -520,12 +533,99 @@ char Usart0::receiveDataStd(FILE *stream_p)
 
 int16_t Usart0::sendDataStd(char data_p, FILE *stream_p)
 {
-    waitUntilBitIsSet(UCSR0A, UDRE0);	// Waits until last transmission ends
-    UDR0 = data_p;
+    // Never blocks: dropped bytes are counted by queueData()
+    this->queueData((uint8_t)data_p);
 
     return 0;
 }
 
+bool_t Usart0::queueData(cuint8_t data_p)
+{
+    bool_t queued = false;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if(this->_txCount < USART0_TX_BUFFER_SIZE) {
+            this->_txBuffer[(uint8_t)(this->_txHead + this->_txCount) & (USART0_TX_BUFFER_SIZE - 1)] = data_p;
+            this->_txCount++;
+            setBit(UCSR0B, UDRIE0);     // ISR drains the buffer
+            queued = true;
+        } else if(this->_txDropped != 0xFFFF) {
+            this->_txDropped++;
+        }
+    }
+
+    if(!queued) {
+        // Returns error
+        this->_lastError = Error::BUFFER_FULL;
+        return false;
+    }
+
+    // Returns successfully
+    this->_lastError = Error::NONE;
+    return true;
+}
+
+uint16_t Usart0::getTransmissionBufferUsage(void)
+{
+    uint16_t aux16;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        aux16 = this->_txCount;
+    }
+
+    return aux16;
+}
+
+uint16_t Usart0::getTransmissionDroppedCount(void)
+{
+    uint16_t aux16;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        aux16 = this->_txDropped;
+    }
+
+    return aux16;
+}
+
+void Usart0::clearTransmissionDroppedCount(void)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        this->_txDropped = 0;
+    }
+
+    return;
+}
+
+void Usart0::flushTransmissionBuffer(void)
+{
+    // Without interrupts the buffer would never drain
+    if(isBitClr(SREG, SREG_I)) {
+        return;
+    }
+
+    while(this->getTransmissionBufferUsage() != 0) {
+        // Waits for the USART_UDRE interrupt
+    }
+
+    return;
+}
+
+bool_t Usart0::transmissionBufferHandler(void)
+{
+    if(this->_txCount == 0) {
+        return false;                   // Interrupt enabled by the user
+    }
+
+    UDR0 = this->_txBuffer[this->_txHead];
+    this->_txHead = (this->_txHead + 1) & (USART0_TX_BUFFER_SIZE - 1);
+    this->_txCount--;
+    if(this->_txCount == 0) {
+        clrBit(UCSR0B, UDRIE0);         // Nothing left, stop the interrupt
+    }
+
+    return true;
+}
+
 int usartTransmitStdWrapper(char c, FILE *f)
 {
     return usartDefaultHandler->sendDataStd(c, f);
@@ -578,7 +678,9 @@ ISR(USART_TX_vect)
 //!
 ISR(USART_UDRE_vect)
 {
-    usartTransmissionBufferEmptyCallback();
+    if(!usart0.transmissionBufferHandler()) {
+        usartTransmissionBufferEmptyCallback();
+    }
 }
 
 #endif // defined(_FUNSAPE_PLATFORM_AVR)
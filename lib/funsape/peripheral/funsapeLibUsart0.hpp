@@ -88,7 +88,14 @@ extern FILE usartStream;
 // Constant definitions
 // =============================================================================
 
-// NONE
+//!
+//! \brief          Size of the transmission ring buffer (bytes).
+//! \details        Must be a power of two not greater than 256. Can be
+//!                     overridden at compile time (-DUSART0_TX_BUFFER_SIZE=n).
+//!
+#ifndef USART0_TX_BUFFER_SIZE
+#   define USART0_TX_BUFFER_SIZE                128
+#endif
 
 // =============================================================================
 // New data types
@@ -309,7 +316,9 @@ public:
         BAUD_RATE_115200                = 115200UL,     //!< Baud rate = 115,200 bps.
         BAUD_RATE_128000                = 128000UL,     //!< Baud rate = 128,000 bps.
         BAUD_RATE_230400                = 230400UL,     //!< Baud rate = 230,400 bps.
-        BAUD_RATE_256000                = 256000UL      //!< Baud rate = 256,000 bps.
+        BAUD_RATE_256000                = 256000UL,     //!< Baud rate = 256,000 bps.
+        BAUD_RATE_500000                = 500000UL,     //!< Baud rate = 500,000 bps (exact at 16 MHz).
+        BAUD_RATE_1000000               = 1000000UL     //!< Baud rate = 1,000,000 bps (exact at 16 MHz, use Mode::ASYNCHRONOUS_DOUBLE_SPEED).
     };
     // -------------------------------------------------------------------------
     // Constructors ------------------------------------------------------------
@@ -580,13 +589,64 @@ public:
 
     //!
     //! \brief      Sends data via standard data stream.
-    //! \details    Sends data via standard data stream.
+    //! \details    Sends data via standard data stream. The character is
+    //!                 queued in the transmission buffer and never blocks; it
+    //!                 is dropped (and counted) if the buffer is full.
     //! \param[in]  data_p              Data to be transmitted.
     //! \param[out] stream_p            Pointer to data stream.
     //! \return     int16_t             Always returns 0.
     //!
     int16_t sendDataStd(char data_p, FILE *stream_p);
 
+    //     ////////////////     TRANSMISSION BUFFER     /////////////////     //
+
+    //!
+    //! \brief      Queues a byte for interrupt-driven transmission.
+    //! \details    Queues a byte in the transmission ring buffer, which is
+    //!                 drained by the USART Data Register Empty interrupt.
+    //!                 Safe to call from interrupt handlers.
+    //! \param[in]  data_p              Data to be transmitted.
+    //! \retval     true                Success.
+    //! \retval     false               Buffer full, the byte was dropped
+    //!                                     (Error::BUFFER_FULL).
+    //!
+    bool_t queueData(cuint8_t data_p);
+
+    //!
+    //! \brief      Returns the number of bytes waiting in the transmission
+    //!                 buffer.
+    //! \return     uint16_t            Bytes queued.
+    //!
+    uint16_t getTransmissionBufferUsage(void);
+
+    //!
+    //! \brief      Returns the number of bytes dropped because the
+    //!                 transmission buffer was full.
+    //! \return     uint16_t            Bytes dropped (saturates at 0xFFFF).
+    //!
+    uint16_t getTransmissionDroppedCount(void);
+
+    //!
+    //! \brief      Clears the dropped bytes counter.
+    //!
+    void clearTransmissionDroppedCount(void);
+
+    //!
+    //! \brief      Waits until every queued byte has been moved to the
+    //!                 transmitter.
+    //! \details    Blocks; meant for shutdown/sleep paths. Returns
+    //!                 immediately if called with global interrupts disabled.
+    //!
+    void flushTransmissionBuffer(void);
+
+    //!
+    //! \brief      Transmission buffer interrupt handler.
+    //! \details    Moves the next queued byte to UDR0. Called by the
+    //!                 USART_UDRE interrupt service routine.
+    //! \return     bool_t              true if a byte was sent.
+    //!
+    bool_t transmissionBufferHandler(void);
+
     //     /////////////////     CONTROL AND STATUS    //////////////////     //
     //!
     //! \brief      Returns the last error.
@@ -620,6 +680,12 @@ private:
     bool_t  _isTransmitterEnabled                       : 1;
     Error   _lastError;
 
+    //     ////////////////     TRANSMISSION BUFFER     /////////////////     //
+    uint8_t             _txBuffer[USART0_TX_BUFFER_SIZE];
+    volatile uint8_t    _txHead;                        // Next byte to send
+    volatile uint16_t   _txCount;                       // Bytes in buffer
+    volatile uint16_t   _txDropped;
+
     //     ////////////////////     CONFIGURATION    ////////////////////     //
     DataSize        _dataSize;
     Mode            _mode;
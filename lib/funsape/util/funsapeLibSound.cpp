@@ -1,24 +1,181 @@
-
 #include "funsapeLibSound.hpp"
 
 #if defined(_FUNSAPE_PLATFORM_AVR)
 
-bool_t playNotes(Note *notes_p)
+#include <avr/pgmspace.h>
+#include <avr/power.h>
+#include <util/atomic.h>
+
+// Timer settings for each note (CTC, SOUND_PIN toggles at every compare match)
+static const Timer1::ClockSource notesPrescaler[] PROGMEM = {Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1};
+
+static const uint16_t notesOcrValue[] PROGMEM = {61161, 57736, 54495, 51413, 48543, 45808, 43252, 40815, 38520, 36363, 34316, 32393, 30580, 28859, 27240, 25713, 24271, 22909, 21621, 20407, 19263, 18181, 17160, 16196, 15287, 14429, 13619, 12856, 12133, 11452, 10810, 10203, 9630, 9090, 8580, 64792, 61156, 57723, 54484, 51426, 48540, 45815, 43242, 40815, 38525, 36363, 34322, 32396, 30577, 28861, 27241, 25712, 24269, 22907, 21621, 20407, 19262, 18181, 17160, 16197, 15288, 14430, 13620, 12856, 12134, 11453, 10810, 10203, 9630, 9090, 8580, 8098, 7644, 7214, 6809, 6427, 6066, 5726, 5404, 5101, 4815, 4544, 4289, 4049, 3821, 3607, 3404, 3213, 3033, 2862, 2702, 2550, 2407, 2272, 2144, 2024, 1910, 1803, 1702, 1606, 1516, 1431, 1350, 1275, 1203, 1135, 1072, 1011};
+
+// Rests: prescaler 64, 1 kHz compare rate, so one match per millisecond
+#define REST_OCR_VALUE                  (uint16_t)(F_CPU / 64 / 1000 - 1)
+
+static const NoteEvent *queue[SOUND_QUEUE_SIZE];
+static uint8_t queueHead = 0;
+static uint8_t queueCount = 0;
+
+static const NoteEvent *melody = nullptr;   // NULL when idle
+static volatile uint32_t matchesLeft = 0;
+static bool_t toggling = false;             // note playing: the ISR toggles SOUND_PIN
+static volatile bool_t finished = false;
+
+static uint16_t prescalerDivision(const Timer1::ClockSource clockSource_p)
+{
+    switch(clockSource_p) {
+    case Timer1::ClockSource::PRESCALER_1:      return 1;
+    case Timer1::ClockSource::PRESCALER_8:      return 8;
+    case Timer1::ClockSource::PRESCALER_64:     return 64;
+    case Timer1::ClockSource::PRESCALER_256:    return 256;
+    default:                                    return 1024;
+    }
+}
+
+// Must run with interrupts disabled
+static void silence(void)
+{
+    timer1.setClockSource(Timer1::ClockSource::DISABLED);
+    timer1.deactivateCompareAInterrupt();
+    toggling = false;
+    clrBit(SOUND_PORT, SOUND_PIN);
+}
+
+// Loads the next event, moving to the next queued melody at Note::END.
+// Must run with interrupts disabled.
+static void nextEvent(void)
 {
-    uint8_t i = 0;
+    while(melody != nullptr) {
+        Note note = (Note)pgm_read_byte(&melody->note);
+        uint16_t durationMs = pgm_read_word(&melody->durationMs);
+
+        // Note::END, or anything past the tables other than a rest, ends the melody
+        if(note != Note::REST && (uint8_t)note >= (uint8_t)Note::END) {
+            if(queueCount) {
+                melody = queue[queueHead];
+                queueHead = (queueHead + 1) % SOUND_QUEUE_SIZE;
+                queueCount--;
+            } else {
+                melody = nullptr;
+                silence();
+                finished = true;
+            }
+            continue;
+        }
+        melody++;
+        if(durationMs == 0) {
+            continue;
+        }
+
+        Timer1::ClockSource clockSource;
+        uint16_t ocrValue;
+        if(note == Note::REST) {
+            clockSource = Timer1::ClockSource::PRESCALER_64;
+            ocrValue = REST_OCR_VALUE;
+            toggling = false;
+            clrBit(SOUND_PORT, SOUND_PIN);
+        } else {
+            clockSource = (Timer1::ClockSource)pgm_read_byte(&notesPrescaler[(uint8_t)note]);
+            ocrValue = pgm_read_word(&notesOcrValue[(uint8_t)note]);
+            toggling = true;
+        }
 
-    while(notes_p[i] != Note::END) {
+        // Compare matches in durationMs (rounded), at least one
+        uint32_t period = (uint32_t)prescalerDivision(clockSource) * ((uint32_t)ocrValue + 1);
+        uint32_t matches = ((uint32_t)durationMs * (F_CPU / 1000UL) + period / 2) / period;
+        matchesLeft = matches ? matches : 1;
+
+        timer1.setClockSource(Timer1::ClockSource::DISABLED);
         timer1.setCounterValue(0);
-        timer1.setClockSource(notesPrescaler[(uint8_t)notes_p[i]]);
-        timer1.setCompareAValue(notesOcrValue[(uint8_t)notes_p[i]]);
-        i++;
-        delayMs(125);
+        timer1.setCompareAValue(ocrValue);
+        timer1.clearCompareAInterruptRequest();
+        timer1.activateCompareAInterrupt();
+        timer1.setClockSource(clockSource);
+        return;
+    }
+}
+
+// Must run with interrupts disabled
+static void startMelody(const NoteEvent *melody_p)
+{
+    finished = false;
+    power_timer1_enable();          // TIMER1 may be gated in PRR while idle
+    timer1.init(Timer1::Mode::CTC_OCRA, Timer1::ClockSource::DISABLED);
+    timer1.setOutputMode(Timer1::OutputMode::NORMAL, Timer1::OutputMode::NORMAL);
+    clrBit(SOUND_PORT, SOUND_PIN);
+    setBit(SOUND_DDR, SOUND_PIN);
+    melody = melody_p;
+    nextEvent();
+}
+
+bool_t playNotes(const NoteEvent *melody_p)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        queueCount = 0;
+        startMelody(melody_p);
     }
-    timer1.setCounterValue(0);
-    timer1.setClockSource(Timer1::ClockSource::DISABLED);
-    clrBit(PORTB, PB1);
 
     return true;
 }
 
+bool_t queueNotes(const NoteEvent *melody_p)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if(melody == nullptr) {
+            startMelody(melody_p);
+            return true;
+        }
+        if(queueCount == SOUND_QUEUE_SIZE) {
+            return false;
+        }
+        queue[(queueHead + queueCount) % SOUND_QUEUE_SIZE] = melody_p;
+        queueCount++;
+    }
+
+    return true;
+}
+
+void stopNotes(void)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        queueCount = 0;
+        melody = nullptr;
+        silence();
+    }
+}
+
+bool_t isPlayingNotes(void)
+{
+    bool_t playing;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        playing = (melody != nullptr);
+    }
+    return playing;
+}
+
+bool_t notesFinished(void)
+{
+    bool_t done;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        done = finished;
+        finished = false;
+    }
+    return done;
+}
+
+void timer1CompareACallback(void)
+{
+    // Toggle first: the edge stays a fixed latency after the compare match
+    if(toggling) {
+        cplBit(SOUND_PORT, SOUND_PIN);
+    }
+    if(--matchesLeft == 0) {
+        nextEvent();
+    }
+}
+
 #endif // defined(_FUNSAPE_PLATFORM_AVR)
@@ -116,7 +116,8 @@ enum class Note : uint8_t {
     NOTE_A8             = 105,
     NOTE_AS8            = 106,
     NOTE_B8             = 107,
-    END                 = 108
+    END                 = 108,
+    REST                = 109
 };
 
 inline bool operator==(const Note note1, const Note note2)
@@ -129,11 +130,72 @@ inline bool operator!=(const Note note1, const Note note2)
     return !(note1 == note2);
 }
 
-Timer1::ClockSource notesPrescaler[] = {Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_8, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1, Timer1::ClockSource::PRESCALER_1};
+//!
+//! \brief      One step of a melody, stored in program memory.
+//! \details    Note::REST keeps silence for durationMs; Note::END (any
+//!                 duration) terminates the melody.
+//!
+typedef struct {
+    Note        note;
+    uint16_t    durationMs;
+} NoteEvent;
 
-cuint16_t notesOcrValue[] = {61161, 57736, 54495, 51413, 48543, 45808, 43252, 40815, 38520, 36363, 34316, 32393, 30580, 28859, 27240, 25713, 24271, 22909, 21621, 20407, 19263, 18181, 17160, 16196, 15287, 14429, 13619, 12856, 12133, 11452, 10810, 10203, 9630, 9090, 8580, 64792, 61156, 57723, 54484, 51426, 48540, 45815, 43242, 40815, 38525, 36363, 34322, 32396, 30577, 28861, 27241, 25712, 24269, 22907, 21621, 20407, 19262, 18181, 17160, 16197, 15288, 14430, 13620, 12856, 12134, 11453, 10810, 10203, 9630, 9090, 8580, 8098, 7644, 7214, 6809, 6427, 6066, 5726, 5404, 5101, 4815, 4544, 4289, 4049, 3821, 3607, 3404, 3213, 3033, 2862, 2702, 2550, 2407, 2272, 2144, 2024, 1910, 1803, 1702, 1606, 1516, 1431, 1350, 1275, 1203, 1135, 1072, 1011};
+//! Melodies waiting behind the one being played
+#define SOUND_QUEUE_SIZE                4
 
-bool_t playNotes(Note *notes_p);
+//!
+//! \brief      Output pin, toggled by the TIMER1 compare A interrupt.
+//! \details    OC1A (PB1) is not used: on the oximeter board it is the DC
+//!                 line of the ST7735 display (LCD_DC), and driving it from
+//!                 the timer would corrupt display transfers. Override all
+//!                 three macros to move the speaker to another free pin.
+//!
+#ifndef SOUND_PORT
+#   define SOUND_PORT                   PORTD
+#   define SOUND_DDR                    DDRD
+#   define SOUND_PIN                    PD5
+#endif
+
+//!
+//! \brief      Starts a melody, stopping the current one and clearing the
+//!                 queue.
+//! \details    Non-blocking. TIMER1 runs in CTC mode with OC1A
+//!                 disconnected; its compare A interrupt toggles SOUND_PIN
+//!                 (made an output here) and times each note by counting
+//!                 half-periods, so the interrupt rate is twice the note
+//!                 frequency. Rests run the timer at 1 kHz with the pin low.
+//! \param      melody_p            NoteEvent array in PROGMEM, ended by
+//!                                     Note::END.
+//! \retval     true                Melody started.
+//!
+bool_t playNotes(const NoteEvent *melody_p);
+
+//!
+//! \brief      Plays a melody after the current one and those already
+//!                 queued (starts it at once if nothing is playing).
+//! \param      melody_p            NoteEvent array in PROGMEM, ended by
+//!                                     Note::END.
+//! \retval     true                Melody started or queued.
+//! \retval     false               Queue full.
+//!
+bool_t queueNotes(const NoteEvent *melody_p);
+
+//!
+//! \brief      Stops the current melody and clears the queue. Does not set
+//!                 the completion flag.
+//!
+void stopNotes(void);
+
+//!
+//! \brief      Returns true while a melody is playing.
+//!
+bool_t isPlayingNotes(void);
+
+//!
+//! \brief      Completion flag: true once after the last queued melody ends.
+//! \details    The flag is cleared by the read.
+//!
+bool_t notesFinished(void);
 
 #endif // defined(_FUNSAPE_PLATFORM_AVR)
 
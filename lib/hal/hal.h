@@ -0,0 +1,128 @@
+//!
+//! \file           hal.h
+//! \brief          Camada de abstracao de hardware do oximetro (AVR e Linux)
+//! \author         Paulo Donizete Antunes Junior
+//! \date           2025-08-14
+//! \version        1.0
+//! \details        Separa o fluxo da aplicacao dos perifericos: base de tempo
+//!                 (Timer0), leitura do sensor (TWI), display (SPI) e console
+//!                 (USART). No AVR as funcoes usam os drivers de lib/; no PC
+//!                 (qualquer alvo sem __AVR__) o sensor reproduz uma captura
+//!                 CSV e o display vira um log em stdout, o que permite rodar
+//!                 a cadeia real (lib/MAX30102/oximetro) em tools/replay.cpp.
+//!
+//!                 Console: printf nos dois alvos (usart0.stdio() no AVR, stdout
+//!                 no PC), por isso nao ha funcao propria aqui. Os quadros binarios
+//!                 de lib/telemetry saem por hal_serial_*.
+//!
+
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../MAX30102/MAX30102.h"
+
+// =============================================================================
+// Base de tempo: ticks de 0.5 ms
+// =============================================================================
+
+// AVR: chamada pelo Timer0 (CTC 0.5 ms). PC: avancada pela reproducao, na taxa
+// de hal_replay_taxa.
+void hal_tick(void);
+uint32_t hal_ticks(void);
+
+// =============================================================================
+// Sensor
+// =============================================================================
+
+// Sinaliza A_FULL, PROX_INT ou DIE_TEMP_RDY (INT0 no AVR)
+void hal_sensor_pedido(void);
+
+// Bloco de amostras cruas, sem bloquear. Devolve NULL enquanto nao houver bloco
+// pronto; caso contrario *n amostras validas (0 = FIFO vazia: PROX_INT, ou falha
+// no I2C, e entao o pedido e refeito).
+const max30102Sample_t* hal_sensor_bloco(uint8_t* n);
+
+// true enquanto houver pedido ou drenagem em andamento: hal_sensor_bloco deve
+// ser chamada de novo ate entregar o bloco
+bool hal_sensor_ocupado(void);
+
+// Resultado do barramento no ultimo bloco (SUCCESS ou TW_ERR_*)
+ret_code_t hal_sensor_status(void);
+
+// Modo de proximidade (lib/MAX30102/presenca.h). hal_sensor_proximidade: true uma
+// vez depois de um PROX_INT (o sensor ja passou a aquisicao completa). A arma volta
+// o sensor ao modo de proximidade. PC: nunca ha PROX_INT e armar nao faz nada.
+bool hal_sensor_proximidade(void);
+ret_code_t hal_sensor_arma_proximidade(void);
+
+// Temperatura do die (curva do SpO2 em calcMaster.h). A inicia dispara uma conversao
+// e deve ser chamada logo depois de um bloco: os ~29 ms terminam muito antes do
+// proximo A_FULL, e o DIE_TEMP_RDY adianta uma drenagem curta. hal_sensor_temperatura:
+// true uma vez com a leitura nova em 1/16 C. PC: nunca ha conversao.
+ret_code_t hal_sensor_temperatura_inicia(void);
+bool hal_sensor_temperatura(int16_t* tempQ4);
+
+// Ganho do sensor (lib/MAX30102/ganho.h); cada funcao so grava o que mudou.
+// PC: sem efeito, a captura ja tem o ganho com que foi feita.
+ret_code_t hal_sensor_leds(uint8_t paRed, uint8_t paIr);
+ret_code_t hal_sensor_faixa(uint16_t faixaNa);
+
+// Amostras perdidas logo antes do ultimo bloco (0 = continuo com o anterior).
+// AVR: OVF_COUNTER da FIFO. PC: saltos no indice da captura.
+uint8_t hal_sensor_perdidas(void);
+
+// =============================================================================
+// Display
+// =============================================================================
+
+// Inicia o display e desenha a tela inicial (logo, campos e faixa da onda)
+void hal_display_init(void);
+
+// Redesenha logo e campos para o modo atual (debug mostra os valores crus)
+void hal_display_modo(bool debug);
+
+// Campos de BPM e SpO2 (redesenham apenas o que mudou)
+void hal_display_medidas(uint16_t bpm_x100, uint16_t spo2_x100);
+
+// Ultima amostra crua RED/IR (modo debug)
+void hal_display_cru(uint32_t red, uint32_t ir);
+
+// Proxima amostra do pletismograma
+void hal_display_onda(int32_t valor);
+
+// =============================================================================
+// Serial: bytes da telemetria (lib/telemetry)
+// =============================================================================
+
+// true quando n bytes cabem no buffer de transmissao. AVR: espera o buffer
+// esvaziar se as interrupcoes estiverem ligadas; false = nao cabe sem travar, e o
+// quadro deve ser descartado. PC: sempre true.
+bool hal_serial_espaco(uint8_t n);
+
+// Enfileira um byte. PC: vai para o arquivo de hal_replay_serial, se houver.
+void hal_serial_envia(uint8_t byte);
+
+// =============================================================================
+// Exclusivo do PC: fonte da reproducao
+// =============================================================================
+
+#if !defined(__AVR__)
+// Abre a captura: CSV "amostra,red,ir" (tools/telemetry_decoder) ou "red,ir".
+// Linhas que nao comecam com numero (cabecalho) sao ignoradas.
+bool hal_replay_abre(const char* arquivo);
+
+// true depois que a captura terminou e o ultimo bloco foi entregue
+bool hal_replay_fim(void);
+
+// Taxa da captura em mHz, para a base de tempo. Padrao: a taxa de saida da FIFO
+// do firmware (MAX30102_PADRAO_TAXA_EFETIVA_MHZ).
+void hal_replay_taxa(uint32_t taxa_mhz);
+
+// Arquivo que recebe os bytes de hal_serial_envia (tools/telemetry_decoder le de
+// volta); NULL descarta. false se nao abrir.
+bool hal_replay_serial(const char* arquivo);
+#endif
+
+#endif // HAL_H
@@ -0,0 +1,532 @@
+//!
+//! \file           hal.cpp
+//! \brief          Camada de abstracao de hardware do oximetro (AVR e Linux)
+//! \author         Paulo Donizete Antunes Junior
+//! \date           2025-08-14
+//! \version        1.0
+//! \details        Ver hal.h. O alvo e escolhido por __AVR__: no AVR este
+//!                 arquivo usa os drivers de lib/, no PC implementa a reproducao.
+//!
+
+#include "hal.h"
+
+#if defined(__AVR__)
+
+// =============================================================================
+// Backend AVR
+// =============================================================================
+
+#include "../funsape/funsapeLibGlobalDefines.hpp"
+#include "../funsape/peripheral/funsapeLibInt0.hpp"
+#include "../funsape/peripheral/funsapeLibUsart0.hpp"
+#include "../st7735/st7735.h"
+#include "../../fonts/Font_8_Retro.h"
+#include "../perf/perf.h"
+
+#include <util/atomic.h>
+
+// Tempo ----------------------------------------------------------------------
+
+static volatile uint32_t ticks = 0;
+
+void hal_tick(void)
+{
+    ticks++;
+}
+
+uint32_t hal_ticks(void)
+{
+    uint32_t agora;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        agora = ticks;
+    }
+    return agora;
+}
+
+// Sensor -----------------------------------------------------------------------
+
+// Buffer de leitura em rajada da FIFO do MAX30102
+static max30102Sample_t amostras[MAX30102_FIFO_SIZE];
+static volatile bool    pedido = false;
+static bool             drenando = false;
+static bool             proximidade = false;
+static bool             temperaturaNova = false;
+static int16_t          temperaturaQ4;
+static ret_code_t       statusSensor = SUCCESS;
+
+void hal_sensor_pedido(void)
+{
+    pedido = true;
+}
+
+const max30102Sample_t* hal_sensor_bloco(uint8_t* n)
+{
+    // Dispara a drenagem da FIFO sem bloquear: os bytes chegam por TWI_vect
+    // enquanto o chamador segue atualizando o display.
+    if (pedido && startFIFOBurst(amostras, MAX30102_FIFO_SIZE)) {
+        pedido = false;
+        drenando = true;
+    }
+
+    if (!pollFIFOBurst(n, &statusSensor)) {
+        return NULL;
+    }
+    drenando = false;
+
+    if (*n == 0 && statusSensor != SUCCESS) {
+        // Falha no I2C ja recuperada: as amostras continuam na FIFO, tenta de novo
+        pedido = true;
+        return amostras;
+    }
+
+    // Limpa os status de interrupcao para o MAX30102 voltar a sinalizar. FIFO
+    // vazia: a interrupcao foi o PROX_INT, e o proximo bloco vem com o A_FULL.
+    uint8_t intStatus[2] = { 0, 0 };
+    readRegisters(MAX30102_INT_STATUS_1, intStatus, 2);
+    max30102StatusPendente(intStatus);  // ja lidos pela drenagem (FIFO vazia ou cheia)
+    int0.clearInterruptRequest();
+    if (intStatus[0] & MAX30102_INT_PROX_INT) {
+        proximidade = true;
+    }
+    // So depois de uma conversao pedida: sem polling do DIE_TEMP_CONFIG
+    if ((intStatus[1] & MAX30102_INT_DIE_TEMP_RDY) &&
+        max30102TemperaturaLe(&temperaturaQ4) == SUCCESS) {
+        temperaturaNova = true;
+    }
+    return amostras;
+}
+
+bool hal_sensor_ocupado(void)
+{
+    return pedido || drenando;
+}
+
+ret_code_t hal_sensor_status(void)
+{
+    return statusSensor;
+}
+
+uint8_t hal_sensor_perdidas(void)
+{
+    return max30102PerdidasBloco();
+}
+
+bool hal_sensor_proximidade(void)
+{
+    bool houve = proximidade;
+    proximidade = false;
+    return houve;
+}
+
+ret_code_t hal_sensor_arma_proximidade(void)
+{
+    return max30102ArmaProximidade();
+}
+
+ret_code_t hal_sensor_temperatura_inicia(void)
+{
+    return max30102TemperaturaInicia();
+}
+
+bool hal_sensor_temperatura(int16_t* tempQ4)
+{
+    if (!temperaturaNova) {
+        return false;
+    }
+    temperaturaNova = false;
+    *tempQ4 = temperaturaQ4;
+    return true;
+}
+
+ret_code_t hal_sensor_leds(uint8_t paRed, uint8_t paIr)
+{
+    return max30102Leds(paRed, paIr);
+}
+
+ret_code_t hal_sensor_faixa(uint16_t faixaNa)
+{
+    return max30102FaixaAdc(faixaNa);
+}
+
+// Display ----------------------------------------------------------------------
+
+// Pletismograma na faixa inferior (linhas 122..159), rolada pelo proprio ST7735
+#define ONDA_TOPO    122
+#define ONDA_LINHAS  38
+#define ONDA_DECIMA  2     // 62.5 Hz / 2: ~1.2 s de curva visivel
+
+// Campos de texto (orientacao 2), redesenhados por celula de glifo
+static LCD_Text_Field campoBpm;
+static LCD_Text_Field campoSpo2;
+static LCD_Wave       onda;
+static char           texto[24];
+
+void hal_display_init(void)
+{
+    LCD_Init(2, 3);
+    LCD_Rect_Fill(0, 0, 160, 128, BLACK);
+    LCD_Text_Field_Init(&campoBpm,  28,  70, _8_Retro, 1, WHITE, BLACK);
+    LCD_Text_Field_Init(&campoSpo2, 28, 119, _8_Retro, 1, WHITE, BLACK);
+    hal_display_modo(false); // Desenha logo do ifsc + o nome do autor
+    LCD_Wave_Init(&onda, ONDA_TOPO, ONDA_LINHAS, ONDA_DECIMA, GREEN, BLACK); // o modo deixa a orientacao 2
+}
+
+// imagem inicial do simbolo ifsc e nome com o nome do autor
+void hal_display_modo(bool debug)
+{
+    uint32_t color;
+
+    if (debug) {
+        color = BLUE;
+
+        LCD_Orientation(0, 2);
+        LCD_Rect_Fill(65, 71, 52, 32, BLACK);
+        LCD_Font(28, 87, "RED: 0", _8_Retro, 1, WHITE);
+        LCD_Font(28, 103, "IR:  0", _8_Retro, 1, WHITE);
+    } else {
+        color = LIME;
+
+        LCD_Orientation(0, 2);
+        LCD_Rect_Fill(28, 71, 52, 32, BLACK);
+    }
+
+    // Bloco usado para desenhar simbolo do ifsc ---------------------------------
+
+    LCD_Orientation(0, 3);
+
+    LCD_Circle(8, 118, 4, 1, 1, RED);
+
+    //Linha 1
+    LCD_Rect_Fill(4, 101, 9, 9, color);
+    LCD_Rect_Fill(4, 87, 9, 9, color);
+
+    //Linha 2
+    LCD_Rect_Fill(15, 114, 9, 9, color);
+    LCD_Rect_Fill(15, 101, 9, 9, color);
+
+    //Linha 3
+    LCD_Rect_Fill(27, 114, 9, 9, color);
+    LCD_Rect_Fill(27, 101, 9, 9, color);
+    LCD_Rect_Fill(27,  87, 9, 9, color);
+
+    //Linha 4
+    LCD_Rect_Fill(39, 114, 9, 9, color);
+    LCD_Rect_Fill(39, 101, 9, 9, color);
+
+    //---------------------------------------------------------------------------
+
+    LCD_Orientation(0, 2);
+
+    // Escola + autor
+    LCD_Font(48, 18, "-=IFSC=-", _8_Retro, 1, WHITE);
+    LCD_Font(48, 36, "Paulo", _8_Retro, 1, WHITE);
+
+    // Reinicia bpm e SpO2 na tela
+    LCD_Text_Field_Invalidate(&campoBpm);
+    LCD_Text_Field_Invalidate(&campoSpo2);
+    hal_display_medidas(0, 0);
+}
+
+void hal_display_medidas(uint16_t bpm_x100, uint16_t spo2_x100)
+{
+    // Campos opacos: so os digitos que mudaram sao reenviados ao display
+    snprintf(texto, sizeof(texto), "BPM: %u.%02u", bpm_x100 / 100, bpm_x100 % 100);
+    LCD_Text_Field_Set(&campoBpm, texto);
+    snprintf(texto, sizeof(texto), "SpO2: %u%%", spo2_x100 / 100);
+    LCD_Text_Field_Set(&campoSpo2, texto);
+}
+
+void hal_display_cru(uint32_t red, uint32_t ir)
+{
+    LCD_Orientation(0, 2);
+    LCD_Rect_Fill(65, 71, 52, 32, BLACK);
+    snprintf(texto, sizeof(texto), "RED: %lu", (unsigned long)red);
+    LCD_Font(28, 87, texto, _8_Retro, 1, BLUE);
+    snprintf(texto, sizeof(texto), "IR:  %lu", (unsigned long)ir);
+    LCD_Font(28, 103, texto, _8_Retro, 1, WHITE);
+}
+
+void hal_display_onda(int32_t valor)
+{
+    PERF_BEGIN(PERF_LCD_WAVE);
+    LCD_Wave_Push(&onda, valor);
+    PERF_END(PERF_LCD_WAVE);
+}
+
+// Serial -----------------------------------------------------------------------
+
+bool hal_serial_espaco(uint8_t n)
+{
+    // A 1 Mbaud o buffer esvazia 100 bytes/ms: so da para esperar com as
+    // interrupcoes ligadas, senao a USART nunca drena
+    while ((uint16_t)(USART0_TX_BUFFER_SIZE - usart0.getTransmissionBufferUsage()) < n) {
+        if (isBitClr(SREG, SREG_I)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void hal_serial_envia(uint8_t byte)
+{
+    usart0.queueData(byte);
+}
+
+#else
+
+// =============================================================================
+// Backend Linux: reproducao de captura
+// =============================================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+static uint32_t ticks = 0;
+
+void hal_tick(void)
+{
+    ticks++;
+}
+
+uint32_t hal_ticks(void)
+{
+    return ticks;
+}
+
+// Sensor -----------------------------------------------------------------------
+
+static max30102Sample_t amostras[MAX30102_FIFO_SIZE];
+static FILE*            captura = NULL;
+static bool             fim     = true;
+static uint32_t         taxa    = MAX30102_PADRAO_TAXA_EFETIVA_MHZ;
+static uint64_t         lidas   = 0;
+
+// Lacunas no indice "amostra" da captura (perdas registradas pelo decodificador)
+static uint32_t         proximoIndice;
+static bool             temIndice;
+static max30102Sample_t adiada;         // primeira amostra depois de uma lacuna
+static uint32_t         lacunaAdiada = 0;
+static bool             temAdiada    = false;
+static uint8_t          perdidas     = 0;
+
+void hal_replay_taxa(uint32_t taxa_mhz)
+{
+    if (taxa_mhz != 0) {
+        taxa = taxa_mhz;
+    }
+}
+
+bool hal_replay_abre(const char* arquivo)
+{
+    if (captura != NULL && captura != stdin) {
+        fclose(captura);
+    }
+    captura = (arquivo == NULL) ? stdin : fopen(arquivo, "r");
+    fim     = (captura == NULL);
+    ticks   = 0;
+    lidas   = 0;
+    temIndice = false;
+    temAdiada = false;
+    perdidas  = 0;
+    return !fim;
+}
+
+bool hal_replay_fim(void)
+{
+    return fim;
+}
+
+void hal_sensor_pedido(void)
+{
+}
+
+// Le "red,ir" ou "amostra,red,ir"; devolve false no fim do arquivo. *lacuna
+// recebe as amostras que faltam no indice antes desta.
+static bool leAmostra(max30102Sample_t* amostra, uint32_t* lacuna)
+{
+    *lacuna = 0;
+    char linha[96];
+
+    while (fgets(linha, sizeof(linha), captura) != NULL) {
+        if (!isdigit((unsigned char)linha[0])) {
+            continue;   // cabecalho ou linha vazia
+        }
+        unsigned long v[3];
+        int campos = sscanf(linha, "%lu,%lu,%lu", &v[0], &v[1], &v[2]);
+        if (campos == 3) {
+            if (temIndice && v[0] > proximoIndice) {
+                *lacuna = (uint32_t)(v[0] - proximoIndice);
+            }
+            proximoIndice = (uint32_t)v[0] + 1;
+            temIndice     = true;
+            amostra->red  = v[1];
+            amostra->ir   = v[2];
+            return true;
+        }
+        if (campos == 2) {
+            amostra->red = v[0];
+            amostra->ir  = v[1];
+            return true;
+        }
+    }
+    return false;
+}
+
+const max30102Sample_t* hal_sensor_bloco(uint8_t* n)
+{
+    *n = 0;
+    if (fim) {
+        return NULL;
+    }
+
+    // Um bloco por chamada, do tamanho da FIFO, ou ate a proxima lacuna, que
+    // fica para o inicio do bloco seguinte; ticks de 0.5 ms na taxa da captura
+    perdidas = 0;
+    if (temAdiada) {
+        amostras[(*n)++] = adiada;
+        perdidas  = (lacunaAdiada > 0xFF) ? 0xFF : (uint8_t)lacunaAdiada;
+        lidas    += lacunaAdiada + 1;
+        temAdiada = false;
+    }
+    while (*n < MAX30102_FIFO_SIZE) {
+        uint32_t lacuna;
+        if (!leAmostra(&amostras[*n], &lacuna)) {
+            fim = true;
+            break;
+        }
+        if (lacuna != 0) {
+            if (*n != 0) {
+                adiada       = amostras[*n];
+                lacunaAdiada = lacuna;
+                temAdiada    = true;
+                break;
+            }
+            perdidas = (lacuna > 0xFF) ? 0xFF : (uint8_t)lacuna;
+        }
+        lidas += lacuna + 1;
+        (*n)++;
+    }
+    ticks = (uint32_t)(lidas * 2000000ULL / taxa);
+    return amostras;
+}
+
+bool hal_sensor_ocupado(void)
+{
+    return !fim;
+}
+
+ret_code_t hal_sensor_status(void)
+{
+    return SUCCESS;
+}
+
+uint8_t hal_sensor_perdidas(void)
+{
+    return perdidas;
+}
+
+bool hal_sensor_proximidade(void)
+{
+    return false;
+}
+
+ret_code_t hal_sensor_arma_proximidade(void)
+{
+    return SUCCESS;
+}
+
+ret_code_t hal_sensor_temperatura_inicia(void)
+{
+    return SUCCESS;
+}
+
+bool hal_sensor_temperatura(int16_t* tempQ4)
+{
+    (void)tempQ4;
+    return false;
+}
+
+ret_code_t hal_sensor_leds(uint8_t paRed, uint8_t paIr)
+{
+    (void)paRed;
+    (void)paIr;
+    return SUCCESS;
+}
+
+ret_code_t hal_sensor_faixa(uint16_t faixaNa)
+{
+    (void)faixaNa;
+    return SUCCESS;
+}
+
+// Display: log em stdout -------------------------------------------------------
+
+static uint16_t ultimoBpm  = 0xFFFF;
+static uint16_t ultimoSpo2 = 0xFFFF;
+
+void hal_display_init(void)
+{
+    printf("tempo_ms,bpm,spo2\n");
+}
+
+void hal_display_modo(bool debug)
+{
+    (void)debug;
+    ultimoBpm  = 0xFFFF;
+    ultimoSpo2 = 0xFFFF;
+}
+
+void hal_display_medidas(uint16_t bpm_x100, uint16_t spo2_x100)
+{
+    if (bpm_x100 == ultimoBpm && spo2_x100 == ultimoSpo2) {
+        return;
+    }
+    ultimoBpm  = bpm_x100;
+    ultimoSpo2 = spo2_x100;
+    printf("%lu,%u.%02u,%u.%02u\n", (unsigned long)(ticks / 2),
+           bpm_x100 / 100, bpm_x100 % 100, spo2_x100 / 100, spo2_x100 % 100);
+}
+
+void hal_display_cru(uint32_t red, uint32_t ir)
+{
+    (void)red;
+    (void)ir;
+}
+
+void hal_display_onda(int32_t valor)
+{
+    (void)valor;
+}
+
+// Serial: arquivo binario para tools/telemetry_decoder -----------------------------
+
+static FILE* serial = NULL;
+
+bool hal_replay_serial(const char* arquivo)
+{
+    if (serial != NULL) {
+        fclose(serial);
+        serial = NULL;
+    }
+    if (arquivo == NULL) {
+        return true;
+    }
+    serial = fopen(arquivo, "wb");
+    return serial != NULL;
+}
+
+bool hal_serial_espaco(uint8_t n)
+{
+    (void)n;
+    return true;
+}
+
+void hal_serial_envia(uint8_t byte)
+{
+    if (serial != NULL) {
+        fputc(byte, serial);
+    }
+}
+
+#endif
@@ -0,0 +1,66 @@
+//!
+//! \file           medicao.h
+//! \brief          Processamento de cada bloco da FIFO, comum ao firmware e a reproducao
+//! \author         Paulo Donizete Antunes Junior
+//! \date           2025-08-27
+//! \version        1.0
+//! \details        Tudo o que acontece entre um bloco drenado e a proxima leitura:
+//!                 presenca do dedo (e o modo de proximidade), lacunas da FIFO,
+//!                 telemetria do modo debug, Oximetro, controle de ganho e
+//!                 temperatura do die. O hardware so e tocado por lib/hal e
+//!                 lib/telemetry, entao o mesmo codigo roda em src/main.cpp e em
+//!                 tools/replay.cpp (backend Linux da HAL).
+//!
+//!                 Ficam com quem chama as reacoes da interface: buzzer, campos da
+//!                 tela e os pedidos do escalonador, a partir dos MEDICAO_*.
+//!
+
+#ifndef MEDICAO_H
+#define MEDICAO_H
+
+#include <stdint.h>
+#include "../MAX30102/MAX30102.h"
+#include "../MAX30102/oximetro.h"
+#include "../MAX30102/ganho.h"
+#include "../MAX30102/presenca.h"
+
+// Mascara devolvida por Medicao::bloco
+#define MEDICAO_CHEGOU          0x01    // dedo chegou: medidas recomecam
+#define MEDICAO_SAIU            0x02    // dedo saiu: medidas zeradas, ganho inicial
+#define MEDICAO_BATIMENTO       0x04    // bpmX100 e spo2X100 novos
+#define MEDICAO_TEMPERATURA     0x08    // leitura nova do die (temperaturaQ4)
+
+class Medicao {
+public:
+    explicit Medicao(uint8_t decimacao = OXIMETRO_DECIMACAO);
+
+    // Sem dedo, ganho e temperatura iniciais (o sensor nao e regravado)
+    void reset();
+
+    // Bloco de hal_sensor_bloco (n = 0: FIFO vazia, so proximidade e temperatura).
+    // debug liga a telemetria de todas as amostras. Devolve MEDICAO_*.
+    uint8_t bloco(const max30102Sample_t* amostras, uint8_t n, bool debug);
+
+    // Pede uma conversao de temperatura; parte depois do proximo bloco com dedo
+    void pedeTemperatura() { _temperaturaPendente = true; }
+
+    Oximetro&            oximetro() { return _oximetro; }
+    const ControleGanho& ganho() const { return _ganho; }
+    bool                 presente() const { return _presenca.presente(); }
+    int16_t              temperaturaQ4() const { return _temperaturaQ4; }
+    uint16_t             bpmX100() const { return _oximetro.bpmX100(); }
+    uint16_t             spo2X100() const { return _oximetro.spo2X100(); }
+
+private:
+    uint8_t presencaBloco(const max30102Sample_t* amostras, uint8_t n);
+    void    ganhoBloco(uint32_t somaRed, uint32_t somaIr, uint8_t n);
+
+    Oximetro         _oximetro;
+    ControleGanho    _ganho;
+    DetectorPresenca _presenca;
+    int16_t          _temperaturaQ4;
+    bool             _temperaturaPendente;
+    bool             _telemetriaAtiva;
+};
+
+#endif // MEDICAO_H
@@ -0,0 +1,170 @@
+//!
+//! \file           medicao.cpp
+//! \brief          Processamento de cada bloco da FIFO, comum ao firmware e a reproducao
+//! \author         Paulo Donizete Antunes Junior
+//! \date           2025-08-27
+//! \version        1.0
+//! \details        Ver medicao.h
+//!
+
+#include "medicao.h"
+#include "../hal/hal.h"
+#include "../telemetry/telemetry.h"
+#include "../perf/perf.h"
+
+Medicao::Medicao(uint8_t decimacao) : _oximetro(decimacao) {
+    reset();
+}
+
+void Medicao::reset() {
+    _oximetro.reset();
+    _ganho.reset();
+    _presenca.reset();
+    _temperaturaQ4       = SPO2_CALIB_TEMP_PADRAO_C * 16;
+    _temperaturaPendente = false;
+    _telemetriaAtiva     = false;
+    _oximetro.temperatura(_temperaturaQ4);
+}
+
+// Presenca por bloco, pela menor amostra de IR: o bloco em que o dedo sai
+// nao chega ao DSP nem ao controle de ganho
+uint8_t Medicao::presencaBloco(const max30102Sample_t* amostras, uint8_t n) {
+    uint32_t menorIr = UINT32_MAX;
+    for (uint8_t i = 0; i < n; i++) {
+        if (amostras[i].ir < menorIr) {
+            menorIr = amostras[i].ir;
+        }
+    }
+
+    uint8_t eventos = 0;
+    uint8_t presencaEv = _presenca.bloco(menorIr);
+    if (presencaEv & PRESENCA_CHEGOU) {
+        _oximetro.reset();      // nenhum vale do dedo anterior
+        _temperaturaPendente = true;
+        eventos |= MEDICAO_CHEGOU;
+    }
+    if (presencaEv & PRESENCA_SAIU) {
+        _oximetro.reset();
+
+        // O proximo dedo comeca do ganho inicial
+        _ganho.reset();
+        hal_sensor_faixa(_ganho.faixaNa());
+        hal_sensor_leds(_ganho.paRed(), _ganho.paIr());
+        eventos |= MEDICAO_SAIU;
+    }
+    if (presencaEv & PRESENCA_REARMA) {
+        hal_sensor_arma_proximidade();
+    }
+    return eventos;
+}
+
+// Ganho entre blocos: a FIFO acabou de ser drenada, entao as amostras do
+// proximo bloco ja saem com o novo ganho. So o que mudou vai para o I2C.
+void Medicao::ganhoBloco(uint32_t somaRed, uint32_t somaIr, uint8_t n) {
+    uint8_t mudou = _ganho.bloco(somaRed / n, somaIr / n);
+    if (!mudou) {
+        return;
+    }
+    if (mudou & GANHO_MUDOU_FAIXA) {
+        hal_sensor_faixa(_ganho.faixaNa());
+    }
+    if (mudou & (GANHO_MUDOU_RED | GANHO_MUDOU_IR)) {
+        hal_sensor_leds(_ganho.paRed(), _ganho.paIr());
+    }
+    _oximetro.degrau();
+}
+
+uint8_t Medicao::bloco(const max30102Sample_t* amostras, uint8_t n, bool debug) {
+    uint8_t eventos = 0;
+
+    // PROX_INT: algo passou do limiar e o sensor ja mede; o primeiro bloco confirma
+    if (hal_sensor_proximidade()) {
+        _presenca.proximidade();
+    }
+
+    // FIFO vazia (PROX_INT ou DIE_TEMP_RDY): so a temperatura pode ter chegado
+    if (n > 0) {
+        PERF_BEGIN(PERF_PROCESSA_BPM);
+
+        // Cada entrada no modo debug comeca um novo fluxo (seq = 0)
+        if (debug && !_telemetriaAtiva) {
+            telemetriaReset();
+        }
+        _telemetriaAtiva = debug;
+
+        // Rollover da FIFO descartou amostras antes deste bloco: nenhum intervalo
+        // entre vales atravessa a lacuna, e a telemetria pula o mesmo trecho de seq
+        uint8_t perdidas = hal_sensor_perdidas();
+        if (perdidas) {
+            _oximetro.lacuna();
+            if (debug) {
+                telemetriaLacuna(perdidas);
+            }
+        }
+
+        eventos |= presencaBloco(amostras, n);
+
+        uint32_t somaRed = 0;
+        uint32_t somaIr  = 0;
+
+        for (uint8_t i = 0; i < n; i++) {
+            uint32_t red = amostras[i].red;
+            uint32_t ir  = amostras[i].ir;
+            somaRed += red;
+            somaIr  += ir;
+
+            // Modo debug: todas as amostras da FIFO (62.5 sps) saem em quadros binarios,
+            // decodificados no PC por tools/telemetry_decoder
+            if (debug) {
+                telemetriaAmostra(red, ir);
+            }
+
+            if (!_presenca.presente()) {
+                continue;
+            }
+
+            // Filtros do pulso (a media de 16 ja vem do chip), vales e SpO2
+            // por batimento
+            PERF_BEGIN(PERF_OXIMETRO_PUSH);
+            uint8_t oxEventos = _oximetro.push(red, ir);
+            PERF_END(PERF_OXIMETRO_PUSH);
+
+            // Curva na tela: IR invertido (absorcao maior na sistole vira pico)
+            if (oxEventos & OXIMETRO_TENDENCIA) {
+                hal_display_onda(-_oximetro.tendencia());
+            }
+
+            if (!(oxEventos & OXIMETRO_BATIMENTO)) {
+                continue;
+            }
+
+            eventos |= MEDICAO_BATIMENTO;
+            _ganho.batimento(_oximetro.spo2().acIr());
+
+            if (debug) {
+                hal_display_cru(red, ir);
+            }
+        }
+
+        if (_presenca.presente()) {
+            ganhoBloco(somaRed, somaIr, n);
+        }
+
+        PERF_END(PERF_PROCESSA_BPM);
+    }
+
+    // Temperatura do die: cada leitura recalibra a curva do SpO2. A conversao so
+    // parte aqui, com a FIFO recem-drenada, para nao disputar o I2C com a drenagem.
+    int16_t tempQ4;
+    if (hal_sensor_temperatura(&tempQ4)) {
+        _temperaturaQ4 = tempQ4;
+        _oximetro.temperatura(tempQ4);
+        eventos |= MEDICAO_TEMPERATURA;
+    }
+    if (_temperaturaPendente && n && _presenca.presente()) {
+        _temperaturaPendente = false;
+        hal_sensor_temperatura_inicia();
+    }
+
+    return eventos;
+}
@@ -0,0 +1,46 @@
+//!
+//! \file           perf.h
+//! \brief          Marcadores de regiao para medicao de ciclos no simavr
+//! \author         Paulo Donizete Antunes Junior
+//! \date           2025-08-18
+//! \version        1.0
+//! \details        Com PERF_ENABLE definido (build de medicao), PERF_BEGIN/PERF_END
+//!                 escrevem o id da regiao em GPIOR0 (uma instrucao OUT); o
+//!                 tools/simavr/perf_harness.c observa essas escritas e conta os
+//!                 ciclos entre elas. Sem PERF_ENABLE, ou fora do AVR, os macros
+//!                 nao geram codigo. Compativel com C, para o harness usar os nomes.
+//!
+
+#ifndef PERF_H
+#define PERF_H
+
+// Bit 7 do valor escrito em GPIOR0 marca o fim da regiao
+#define PERF_FIM        0x80
+
+// Regioes instrumentadas: X(id, nome no relatorio). PERF_LACO cobre uma volta
+// do escalonador, isto e, a execucao de uma tarefa (lib/sched).
+#define PERF_REGIOES(X) \
+    X(PERF_LACO,                1, "laco_principal")      \
+    X(PERF_PROCESSA_BPM,        2, "processaBPM")         \
+    X(PERF_OXIMETRO_PUSH,       3, "Oximetro::push")      \
+    X(PERF_LCD_FONT,            4, "LCD_Font")            \
+    X(PERF_LCD_TEXT_FIELD,      5, "LCD_Text_Field_Set")  \
+    X(PERF_LCD_WAVE,            6, "LCD_Wave_Push")       \
+    X(PERF_DETECTAR_VALES,      7, "detectarValesEBPM")   \
+    X(PERF_DETECTAR_VALES_X100, 8, "detectarValesEBPMx100")
+
+#define PERF_ENUM_(nome, id, texto) nome = id,
+enum { PERF_REGIOES(PERF_ENUM_) PERF_TOTAL_REGIOES };
+#undef PERF_ENUM_
+
+#if defined(__AVR__) && defined(PERF_ENABLE)
+#include <avr/io.h>
+// A barreira impede o compilador de mover codigo da regiao para fora dos marcadores
+#define PERF_BEGIN(id)  do { __asm__ __volatile__("" ::: "memory"); GPIOR0 = (id); __asm__ __volatile__("" ::: "memory"); } while (0)
+#define PERF_END(id)    do { __asm__ __volatile__("" ::: "memory"); GPIOR0 = (id) | PERF_FIM; __asm__ __volatile__("" ::: "memory"); } while (0)
+#else
+#define PERF_BEGIN(id)  do { } while (0)
+#define PERF_END(id)    do { } while (0)
+#endif
+
+#endif // PERF_H
@@ -0,0 +1,44 @@
+//!
+//! \file           power.h
+//! \brief          Gestao de energia: sono entre eventos, PRR e ciclo ativo
+//! \author         Paulo Donizete Antunes Junior
+//! \date           2025-08-21
+//! \version        1.0
+//! \details        power_init desliga o que o firmware nao usa: ADC e comparador
+//!                 analogico (desligados antes do PRR), Timer1 e Timer2. Modulos
+//!                 que usem Timer1/Timer2 religam o seu no proprio init com
+//!                 power_timer1_enable()/power_timer2_enable() (avr/power.h).
+//!
+//!                 O sono e sempre IDLE: Timer0 (base de tempo), TWI, SPI e USART
+//!                 precisam de clkIO, e INT0/INT1 sao por borda, que so acorda a
+//!                 CPU com clkIO ativo. Power-save pediria Timer2 assincrono com
+//!                 cristal de 32 kHz, e os pinos TOSC ja sao do cristal de 16 MHz.
+//!
+//!                 Ciclo ativo: power_dorme mede o tempo dormido com o TCNT0 (4 us
+//!                 por contagem) e power_tick fecha uma janela a cada
+//!                 POWER_JANELA ticks. A ISR que acorda a CPU roda antes do retorno
+//!                 do sleep e conta como sono (alguns us a cada 0.5 ms).
+//!
+
+#ifndef POWER_H
+#define POWER_H
+
+#include <stdint.h>
+
+#define POWER_JANELA    2000    // ticks de 0.5 ms: janela de 1 s
+
+// Desliga ADC, comparador analogico, Timer1 e Timer2 e escolhe o sono IDLE
+void power_init(void);
+
+// Dorme ate a proxima interrupcao. Deve ser chamada com as interrupcoes
+// desligadas, depois de conferir que nao ha trabalho pendente; volta com
+// as interrupcoes ligadas.
+void power_dorme(void);
+
+// Base de tempo: chamada pelo Timer0 a cada 0.5 ms
+void power_tick(void);
+
+// Fracao do tempo acordado na ultima janela completa, em centesimos de % (0..10000)
+uint16_t power_ciclo_ativo_x100(void);
+
+#endif // POWER_H
@@ -0,0 +1,90 @@
+//!
+//! \file           power.cpp
+//! \brief          Gestao de energia: sono entre eventos, PRR e ciclo ativo
+//! \author         Paulo Donizete Antunes Junior
+//! \date           2025-08-21
+//! \version        1.0
+//! \details        Ver power.h.
+//!
+
+#include "power.h"
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/power.h>
+#include <avr/sleep.h>
+#include <util/atomic.h>
+
+static uint16_t ticks = 0;              // com volta; so diferencas importam
+static uint16_t ticksJanela = 0;
+static uint32_t dormidoJanela = 0;      // contagens de TCNT0 dormidas na janela
+static volatile uint16_t cicloAtivo = 10000;
+
+// Contagens por tick do Timer0 em CTC
+static inline uint16_t contagensPorTick(void)
+{
+    return (uint16_t)OCR0A + 1;
+}
+
+// Tempo em contagens de TCNT0, com interrupcoes desligadas. Um compare match
+// ainda nao atendido (OCF0A) ja zerou o TCNT0 sem que o tick tenha sido contado.
+static uint16_t agoraContagens(void)
+{
+    uint8_t  tcnt  = TCNT0;
+    uint16_t agora = ticks;
+    if (TIFR0 & (1 << OCF0A)) {
+        tcnt = TCNT0;
+        agora++;
+    }
+    return (uint16_t)(agora * contagensPorTick() + tcnt);
+}
+
+void power_init(void)
+{
+    ADCSRA &= ~(1 << ADEN);     // o PRR nao desliga um ADC habilitado
+    ACSR   |= (1 << ACD);
+    power_adc_disable();
+    power_timer1_disable();
+    power_timer2_disable();
+
+    set_sleep_mode(SLEEP_MODE_IDLE);
+}
+
+void power_dorme(void)
+{
+    uint16_t inicio = agoraContagens();
+
+    // sei seguido de sleep executa o sleep antes de qualquer ISR
+    sleep_enable();
+    sei();
+    sleep_cpu();
+    sleep_disable();
+
+    cli();
+    dormidoJanela += (uint16_t)(agoraContagens() - inicio);
+    sei();
+}
+
+// Chamada no ISR do Timer0: interrupcoes ja desligadas
+void power_tick(void)
+{
+    ticks++;
+    if (++ticksJanela < POWER_JANELA) {
+        return;
+    }
+
+    uint32_t total = (uint32_t)POWER_JANELA * contagensPorTick();
+    uint32_t ativo = (dormidoJanela < total) ? total - dormidoJanela : 0;
+    cicloAtivo    = (uint16_t)(ativo * 10000UL / total);
+    ticksJanela   = 0;
+    dormidoJanela = 0;
+}
+
+uint16_t power_ciclo_ativo_x100(void)
+{
+    uint16_t valor;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        valor = cicloAtivo;
+    }
+    return valor;
+}
@@ -0,0 +1,67 @@
+//!
+//! \file           sched.h
+//! \brief          Escalonador cooperativo por eventos (run-to-completion)
+//! \author         Paulo Donizete Antunes Junior
+//! \date           2025-08-20
+//! \version        1.0
+//! \details        Ate SCHED_MAX_EVENTOS eventos, cada um com uma tarefa. O indice
+//!                 do evento e a sua prioridade (0 = maior): a cada passo o
+//!                 escalonador executa a tarefa do evento pendente de menor
+//!                 indice, ate o fim. Postagens repetidas de um evento ainda
+//!                 pendente se acumulam numa unica execucao.
+//!
+//!                 Tarefas longas devem ser divididas em partes, repostando o
+//!                 proprio evento: entre uma parte e outra um evento de maior
+//!                 prioridade (ex.: FIFO do sensor) passa na frente.
+//!
+//!                 Prazo: ticks maximos entre a primeira postagem e o inicio da
+//!                 tarefa. Cada estouro e contado por evento (sched_atrasos), junto
+//!                 com a maior latencia observada.
+//!
+//!                 Base de tempo: sched_tick() no Timer0 (0.5 ms). Sem eventos
+//!                 pendentes a CPU dorme (lib/power) ate a proxima interrupcao.
+//!
+
+#ifndef SCHED_H
+#define SCHED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SCHED_MAX_EVENTOS   8       // um bit por evento na mascara de pendentes
+#define SCHED_SEM_PRAZO     0
+
+typedef void (*sched_tarefa_t)(void);
+
+typedef struct {
+    sched_tarefa_t tarefa;
+    uint16_t       prazo;           // em ticks; SCHED_SEM_PRAZO desliga a verificacao
+} sched_evento_t;
+
+// Tabela de eventos em ordem de prioridade (n <= SCHED_MAX_EVENTOS)
+void sched_init(const sched_evento_t* eventos, uint8_t n);
+
+// Marca o evento como pendente (pode ser chamada em ISR)
+void sched_posta(uint8_t evento);
+
+// Posta o evento daqui a ticks ticks; reagendar substitui o tempo anterior
+// e ticks = 0 cancela o agendamento
+void sched_agenda(uint8_t evento, uint16_t ticks);
+
+// Base de tempo: chamada pelo Timer0 a cada 0.5 ms
+void sched_tick(void);
+
+// Executa a tarefa do evento pendente de maior prioridade. false se nao havia nenhum.
+bool sched_executa(void);
+
+// Dorme (power_dorme) se nao houver evento pendente; volta na proxima interrupcao
+void sched_ocioso(void);
+
+// Laco principal: executa eventos e dorme quando nao ha nada a fazer
+void sched_laco(void) __attribute__((noreturn));
+
+// Estatisticas de prazo por evento
+uint16_t sched_atrasos(uint8_t evento);
+uint16_t sched_latencia_max(uint8_t evento);
+
+#endif // SCHED_H
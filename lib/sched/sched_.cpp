@@ -0,0 +1,135 @@
+//!
+//! \file           sched.cpp
+//! \brief          Escalonador cooperativo por eventos (run-to-completion)
+//! \author         Paulo Donizete Antunes Junior
+//! \date           2025-08-20
+//! \version        1.0
+//! \details        Ver sched.h.
+//!
+
+#include "sched.h"
+#include "../perf/perf.h"
+#include "../power/power.h"
+
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
+static const sched_evento_t* tabela = 0;
+static uint8_t               totalEventos = 0;
+
+static volatile uint8_t  pendentes = 0;                     // bit n = evento n
+static volatile uint16_t agora = 0;                         // ticks, com volta
+static volatile uint16_t postadoEm[SCHED_MAX_EVENTOS];      // tick da primeira postagem
+static volatile uint16_t espera[SCHED_MAX_EVENTOS];         // 0 = sem agendamento
+static uint16_t          atrasos[SCHED_MAX_EVENTOS];
+static uint16_t          latenciaMax[SCHED_MAX_EVENTOS];
+
+// Com as interrupcoes desligadas
+static inline void marcaPendente(uint8_t evento)
+{
+    uint8_t bit = (uint8_t)(1 << evento);
+    if (!(pendentes & bit)) {
+        pendentes |= bit;
+        postadoEm[evento] = agora;
+    }
+}
+
+void sched_init(const sched_evento_t* eventos, uint8_t n)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        tabela       = eventos;
+        totalEventos = (n > SCHED_MAX_EVENTOS) ? SCHED_MAX_EVENTOS : n;
+        pendentes    = 0;
+        for (uint8_t i = 0; i < SCHED_MAX_EVENTOS; i++) {
+            espera[i]      = 0;
+            atrasos[i]     = 0;
+            latenciaMax[i] = 0;
+        }
+    }
+}
+
+void sched_posta(uint8_t evento)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        marcaPendente(evento);
+    }
+}
+
+void sched_agenda(uint8_t evento, uint16_t ticks)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        espera[evento] = ticks;
+    }
+}
+
+// Chamada no ISR do Timer0: interrupcoes ja desligadas
+void sched_tick(void)
+{
+    agora++;
+    for (uint8_t i = 0; i < totalEventos; i++) {
+        if (espera[i] && --espera[i] == 0) {
+            marcaPendente(i);
+        }
+    }
+}
+
+bool sched_executa(void)
+{
+    uint8_t  evento = 0;
+    uint16_t latencia;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        uint8_t p = pendentes;
+        if (p == 0) {
+            return false;
+        }
+        while (!(p & 1)) {
+            p >>= 1;
+            evento++;
+        }
+        pendentes &= (uint8_t)~(1 << evento);
+        latencia = agora - postadoEm[evento];
+    }
+
+    if (latencia > latenciaMax[evento]) {
+        latenciaMax[evento] = latencia;
+    }
+    if (tabela[evento].prazo != SCHED_SEM_PRAZO && latencia > tabela[evento].prazo) {
+        atrasos[evento]++;
+    }
+
+    PERF_BEGIN(PERF_LACO);
+    tabela[evento].tarefa();
+    PERF_END(PERF_LACO);
+    return true;
+}
+
+void sched_ocioso(void)
+{
+    // O teste e o sono sao atomicos: um evento postado depois do teste
+    // ainda acorda a CPU
+    cli();
+    if (pendentes == 0) {
+        power_dorme();
+    }
+    sei();
+}
+
+void sched_laco(void)
+{
+    for (;;) {
+        if (!sched_executa()) {
+            sched_ocioso();
+        }
+    }
+}
+
+uint16_t sched_atrasos(uint8_t evento)
+{
+    return atrasos[evento];
+}
+
+uint16_t sched_latencia_max(uint8_t evento)
+{
+    return latenciaMax[evento];
+}
@@ -87,6 +87,18 @@ uint32_t RGB(uint8_t r, uint8_t g, uint8_t b);
 void LCD_SPI(void);
 void LCD_Init(uint8_t type, uint8_t orientation);
 void LCD_Orientation(uint8_t type, uint8_t orientation);
+
+// Pixel streaming: Begin opens the w x h window at column x, row y and keeps CS
+// asserted; Color/Push write RGB565 pixels in row order with the next byte loaded
+// while the previous one shifts out; End releases the bus. No other LCD call may
+// be made between Begin and End.
+uint16_t LCD_Color565(uint32_t color24);
+void LCD_Stream_Begin(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+void LCD_Stream_Color(uint16_t color, uint32_t count);
+void LCD_Stream_Push(const uint16_t *pixels, uint16_t count);
+void LCD_Stream_Push_P(const uint16_t *pixels, uint16_t count);
+void LCD_Stream_End(void);
+
 void LCD_Pixel(uint16_t x, uint16_t y, uint32_t color24);
 void LCD_Rect_Fill(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint32_t color24);
 void LCD_Line(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint8_t size, uint32_t color24);
@@ -98,6 +110,53 @@ void LCD_Circle(uint16_t x, uint16_t y, uint8_t radius, uint8_t fill, uint8_t si
 void LCD_Rect_Round(uint16_t x, uint16_t y, uint16_t length, uint16_t width, uint16_t r, uint8_t size, uint32_t color24);
 void LCD_Rect_Round_Fill(uint16_t x, uint16_t y, uint16_t length, uint16_t width, uint16_t r, uint32_t color24);
 void LCD_Font(uint16_t x, uint16_t y, const char *text, const GFXfont *p_font, uint8_t size, uint32_t color24);
+void LCD_Font_Opaque(uint16_t x, uint16_t y, const char *text, const GFXfont *p_font, uint8_t size, uint32_t color24, uint32_t bg24);
+
+// Opaque text field: remembers the last string and redraws only changed glyph cells.
+// Single line; the cell of each glyph spans xAdvance x yAdvance (times size) with
+// the baseline y on its last row.
+#define LCD_TEXT_FIELD_LEN 16
+
+typedef struct {
+	uint16_t x, y;
+	GFXfont font;                         // copy of the PROGMEM header
+	uint8_t size;
+	uint16_t color, bg;                   // RGB565
+	char last[LCD_TEXT_FIELD_LEN + 1];
+	uint8_t valid;                        // 0 forces a full redraw
+} LCD_Text_Field;
+
+void LCD_Text_Field_Init(LCD_Text_Field *field, uint16_t x, uint16_t y, const GFXfont *p_font, uint8_t size, uint32_t color24, uint32_t bg24);
+void LCD_Text_Field_Set(LCD_Text_Field *field, const char *text);
+void LCD_Text_Field_Invalidate(LCD_Text_Field *field);
+
+// Hardware vertical scroll. The scroll area is a band of whole frame rows; with
+// orientation 2 (portrait) they are screen rows top..top+lines-1.
+#define LCD_SCROLL_LINES 160 // frame memory rows of the 128x160 panel (162 on 132x162 parts)
+
+void LCD_Scroll_Define(uint16_t top, uint16_t lines);
+void LCD_Scroll_Start(uint16_t line);
+
+// Scrolling waveform (orientation 2): each sample paints one 128-pixel frame row
+// at the bottom of the band and advances the scroll start, so the trace moves up
+// without redrawing. Amplitude runs along the row, autoscaled by a decaying
+// min/max envelope; only every 'decimation'-th sample is drawn.
+#define LCD_WAVE_WIDTH    LCD_HEIGHT // pixels of a frame row
+#define LCD_WAVE_MIN_SPAN 32         // smallest envelope span, in input units
+
+typedef struct {
+	uint16_t top, lines;                  // scroll band
+	uint16_t head;                        // band row painted by the next sample
+	uint16_t color, bg;                   // RGB565
+	uint8_t decimation, skip;
+	uint8_t last_x;
+	uint8_t valid;                        // 0 restarts the envelope and the trace
+	int32_t lo, hi;                       // autoscale envelope
+} LCD_Wave;
+
+void LCD_Wave_Init(LCD_Wave *wave, uint16_t top, uint16_t lines, uint8_t decimation, uint32_t color24, uint32_t bg24);
+void LCD_Wave_Push(LCD_Wave *wave, int32_t value);
+void LCD_Wave_Clear(LCD_Wave *wave);
 void LCD_Bitmap(uint16_t x, uint16_t y, PGM_P bitmap);
 void LCD_Bitmap_Mono(uint16_t x, uint16_t y, PGM_P bitmap, uint32_t color24_set, uint32_t color24_unset);
 
@@ -134,6 +193,8 @@ enum LCD_COMMANDS {
 	RAMRD	= 0x2E,
 
 	PTLAR	= 0x30,
+	VSCRDEF	= 0x33,
+	VSCRSADD	= 0x37,
 	COLMOD	= 0x3A,
 	MADCTL	= 0x36,
 
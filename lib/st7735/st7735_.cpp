@@ -1,4 +1,5 @@
 #include "st7735.h"
+#include "../perf/perf.h"
 
 uint32_t RGB(uint8_t r, uint8_t g, uint8_t b)
 {
@@ -32,66 +33,170 @@ inline static void LCD_Data_8(uint8_t data)
 	LCD_S_CS
 }
 
-inline static void LCD_Data_16(uint16_t word)
+/*
+ * SPI pipelining: a byte is loaded into SPDR as soon as the previous one has
+ * left the shift register, so whatever the caller computes between two puts
+ * (next colour, next bitmap bit, pgm_read) overlaps the 16-cycle transfer.
+ * LCD_SPI_Flush() must run before DC or CS changes.
+ */
+static uint8_t lcd_spi_busy = 0;
+
+inline static void LCD_SPI_Put(uint8_t byte)
+{
+	if (lcd_spi_busy) while(!(SPSR & (1 << SPIF)));
+	SPDR = byte;
+	lcd_spi_busy = 1;
+}
+
+inline static void LCD_SPI_Flush(void)
+{
+	if (lcd_spi_busy) while(!(SPSR & (1 << SPIF)));
+	lcd_spi_busy = 0;
+}
+
+inline static void LCD_Window_Word(uint16_t word)
+{
+	LCD_SPI_Put(word >> 8);
+	LCD_SPI_Put(word & 0xFF);
+}
+
+// CASET, RASET and RAMWR under a single CS assertion; leaves CS low, DC high
+inline static void LCD_Window(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2)
 {
 	LCD_U_CS
+	LCD_U_DC
+	LCD_SPI_Put(CASET);
+	LCD_SPI_Flush();
+	LCD_S_DC
+	LCD_Window_Word(y1);
+	LCD_Window_Word(y2);
+	LCD_SPI_Flush();
+	LCD_U_DC
+	LCD_SPI_Put(RASET);
+	LCD_SPI_Flush();
+	LCD_S_DC
+	LCD_Window_Word(x1);
+	LCD_Window_Word(x2);
+	LCD_SPI_Flush();
+	LCD_U_DC
+	LCD_SPI_Put(RAMWR);
+	LCD_SPI_Flush();
 	LCD_S_DC
-	SPDR = (word >> 8) & 0x00FF;
-	while(!(SPSR & (1 << SPIF)));
-	SPDR = word & 0x00FF;
-	while(!(SPSR & (1 << SPIF)));
-	LCD_S_CS
 }
 
-inline static void LCD_Window(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2)
+uint16_t LCD_Color565(uint32_t color24)
+{
+	return H24_RGB565(0, color24);
+}
+
+void LCD_Stream_Begin(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+	LCD_Window(y, x, y + h - 1, x + w - 1);
+}
+
+void LCD_Stream_Color(uint16_t color, uint32_t count)
+{
+	uint8_t hi = color >> 8;
+	uint8_t lo = color & 0xFF;
+	while (count--)
+	{
+		LCD_SPI_Put(hi);
+		LCD_SPI_Put(lo);
+	}
+}
+
+void LCD_Stream_Push(const uint16_t *pixels, uint16_t count)
+{
+	while (count--)
+	{
+		uint16_t color = *pixels++;
+		LCD_SPI_Put(color >> 8);
+		LCD_SPI_Put(color & 0xFF);
+	}
+}
+
+void LCD_Stream_Push_P(const uint16_t *pixels, uint16_t count)
 {
-	LCD_Command(CASET);
-	LCD_Data_16(y1);
-	LCD_Data_16(y2);
-	LCD_Command(RASET);
-	LCD_Data_16(x1);
-	LCD_Data_16(x2);
-	LCD_Command(RAMWR);
+	while (count--)
+	{
+		uint16_t color = pgm_read_word(pixels++);
+		LCD_SPI_Put(color >> 8);
+		LCD_SPI_Put(color & 0xFF);
+	}
+}
+
+void LCD_Stream_End(void)
+{
+	LCD_SPI_Flush();
+	LCD_S_CS
 }
 
 void LCD_Pixel(uint16_t x, uint16_t y, uint32_t color24)
 {
-	LCD_Window(x, y, x, y);
-	LCD_Data_16(H24_RGB565(0, color24));
+	// Keeps the historical (transposed) addressing of LCD_Pixel
+	LCD_Stream_Begin(y, x, 1, 1);
+	LCD_Stream_Color(H24_RGB565(0, color24), 1);
+	LCD_Stream_End();
+}
+
+static void LCD_Rect_Fill_565(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
+{
+	LCD_Stream_Begin(x, y, w, h);
+	LCD_Stream_Color(color, (uint32_t) w * (uint32_t) h);
+	LCD_Stream_End();
 }
 
 void LCD_Rect_Fill(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint32_t color24)
 {
-	uint32_t i = 0;
-	uint32_t j = (uint32_t) w * (uint32_t) h;
-	LCD_Window(y, x, y + h - 1, x + w - 1);
-	for (i = 0; i < j; i++) LCD_Data_16(H24_RGB565(0, color24));
+	LCD_Rect_Fill_565(x, y, w, h, H24_RGB565(0, color24));
 }
 
 void LCD_Line(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint8_t size, uint32_t color24)
 {
+	uint16_t color = H24_RGB565(0, color24);
 	int deltaX = abs(x2 - x1);
 	int deltaY = abs(y2 - y1);
 	int signX = x1 < x2 ? 1 : -1;
 	int signY = y1 < y2 ? 1 : -1;
 	int error = deltaX - deltaY;
 	int error2 = 0;
+	uint8_t steep = deltaY > deltaX;
+	uint16_t run_x = x1;
+	uint16_t run_y = y1;
+	/*
+	 * Consecutive points that share a row (shallow lines) or a column (steep
+	 * lines) are drawn as one size-thick rectangle instead of one square each
+	 */
 	for (;;)
 	{
-		LCD_Rect_Fill(x1, y1, size, size, color24);
-		if (x1 == x2 && y1 == y2)
-		break;
-		error2 = error * 2;
-		if (error2 > -deltaY)
+		uint8_t last = (x1 == x2 && y1 == y2);
+		uint16_t px = x1;
+		uint16_t py = y1;
+		if (!last)
 		{
-			error -= deltaY;
-			x1 += signX;
+			error2 = error * 2;
+			if (error2 > -deltaY)
+			{
+				error -= deltaY;
+				x1 += signX;
+			}
+			if (error2 < deltaX)
+			{
+				error += deltaX;
+				y1 += signY;
+			}
 		}
-		if (error2 < deltaX)
+		if (last || (steep ? x1 != px : y1 != py))
 		{
-			error += deltaX;
-			y1 += signY;
+			uint16_t rx = run_x < px ? run_x : px;
+			uint16_t ry = run_y < py ? run_y : py;
+			uint16_t rw = (run_x < px ? px - run_x : run_x - px) + size;
+			uint16_t rh = (run_y < py ? py - run_y : run_y - py) + size;
+			LCD_Rect_Fill_565(rx, ry, rw, rh, color);
+			run_x = x1;
+			run_y = y1;
 		}
+		if (last) break;
 	}
 }
 
@@ -404,6 +509,7 @@ void LCD_Font(uint16_t x, uint16_t y, const char *text, const GFXfont *p_font, u
 	int16_t cursor_x = x;
 	int16_t cursor_y = y;
 	GFXfont font;
+	PERF_BEGIN(PERF_LCD_FONT);
 	memcpy_P(&font, p_font, sizeof(GFXfont));
 	for (uint16_t text_pos = 0; text_pos < strlen(text); text_pos++)
 	{
@@ -421,6 +527,217 @@ void LCD_Font(uint16_t x, uint16_t y, const char *text, const GFXfont *p_font, u
 			cursor_x += glyph.xAdvance * size;
 		}
 	}
+	PERF_END(PERF_LCD_FONT);
+}
+
+// Draws the whole glyph cell (xAdvance x yAdvance, baseline on the last row) in one
+// window: foreground and background pixels go out in a single RAMWR burst.
+// Glyph pixels outside the cell are clipped.
+static void LCD_Char_Opaque(int16_t x, int16_t y, uint8_t c, const GFXfont *font, uint8_t size, uint16_t color, uint16_t bg)
+{
+	GFXglyph glyph;
+	memcpy_P(&glyph, &font -> glyph[c - font -> first], sizeof(GFXglyph));
+
+	uint8_t  *bitmap = font -> bitmap;
+	uint8_t  cell_w = glyph.xAdvance;
+	uint8_t  cell_h = font -> yAdvance;
+	int16_t  top = y - (cell_h - 1) * size;
+	int8_t   gy0 = glyph.yOffset + cell_h - 1;    // first glyph row inside the cell
+
+	LCD_Stream_Begin(x, top, cell_w * size, cell_h * size);
+	for (uint8_t cy = 0; cy < cell_h; cy++)
+	{
+		int8_t gy = cy - gy0;
+		for (uint8_t sy = 0; sy < size; sy++)
+		{
+			for (uint8_t cx = 0; cx < cell_w; cx++)
+			{
+				int8_t gx = cx - glyph.xOffset;
+				uint16_t pixel = bg;
+				if (gy >= 0 && gy < glyph.height && gx >= 0 && gx < glyph.width)
+				{
+					uint16_t bit = (uint16_t) gy * glyph.width + gx;
+					if (pgm_read_byte(&bitmap[glyph.bitmapOffset + (bit >> 3)]) & (0x80 >> (bit & 7))) pixel = color;
+				}
+				LCD_Stream_Color(pixel, size);
+			}
+		}
+	}
+	LCD_Stream_End();
+}
+
+void LCD_Font_Opaque(uint16_t x, uint16_t y, const char *text, const GFXfont *p_font, uint8_t size, uint32_t color24, uint32_t bg24)
+{
+	int16_t cursor_x = x;
+	int16_t cursor_y = y;
+	uint16_t color = H24_RGB565(0, color24);
+	uint16_t bg = H24_RGB565(0, bg24);
+	GFXfont font;
+	memcpy_P(&font, p_font, sizeof(GFXfont));
+	for (; *text; text++)
+	{
+		char c = *text;
+		if (c == '\n')
+		{
+			cursor_x = x;
+			cursor_y += font.yAdvance * size;
+		}
+		else if (c >= font.first && c <= font.last)
+		{
+			LCD_Char_Opaque(cursor_x, cursor_y, c, &font, size, color, bg);
+			cursor_x += pgm_read_byte(&font.glyph[c - font.first].xAdvance) * size;
+		}
+	}
+}
+
+void LCD_Text_Field_Init(LCD_Text_Field *field, uint16_t x, uint16_t y, const GFXfont *p_font, uint8_t size, uint32_t color24, uint32_t bg24)
+{
+	field -> x = x;
+	field -> y = y;
+	memcpy_P(&field -> font, p_font, sizeof(GFXfont));
+	field -> size = size;
+	field -> color = H24_RGB565(0, color24);
+	field -> bg = H24_RGB565(0, bg24);
+	field -> last[0] = '\0';
+	field -> valid = 0;
+}
+
+void LCD_Text_Field_Invalidate(LCD_Text_Field *field)
+{
+	field -> valid = 0;
+}
+
+static uint8_t LCD_Text_Field_Advance(const GFXfont *font, char c)
+{
+	return pgm_read_byte(&font -> glyph[c - font -> first].xAdvance);
+}
+
+void LCD_Text_Field_Set(LCD_Text_Field *field, const char *text)
+{
+	const GFXfont *font = &field -> font;
+	uint8_t size = field -> size;
+	uint8_t old_end = !field -> valid;       // no usable previous string
+	int16_t new_x = field -> x;
+	int16_t old_x = field -> x;
+	uint8_t i = 0;
+
+	PERF_BEGIN(PERF_LCD_TEXT_FIELD);
+	for (; i < LCD_TEXT_FIELD_LEN; i++)
+	{
+		char c = text[i];
+		if (c < font -> first || c > font -> last) break;   // '\0', '\n', '\r' end the field
+
+		char old = old_end ? '\0' : field -> last[i];
+		if (old == '\0') old_end = 1;
+
+		// Redraw when the glyph changed or an earlier width change moved this cell
+		if (c != old || new_x != old_x)
+		{
+			LCD_Char_Opaque(new_x, field -> y, c, font, size, field -> color, field -> bg);
+		}
+		new_x += LCD_Text_Field_Advance(font, c) * size;
+		if (!old_end) old_x += LCD_Text_Field_Advance(font, old) * size;
+		field -> last[i] = c;
+	}
+
+	// Cells of a previous, longer string are cleared to the background
+	for (uint8_t j = i; !old_end && j < LCD_TEXT_FIELD_LEN && field -> last[j] != '\0'; j++)
+	{
+		old_x += LCD_Text_Field_Advance(font, field -> last[j]) * size;
+	}
+	if (old_x > new_x)
+	{
+		uint16_t h = font -> yAdvance * size;
+		LCD_Rect_Fill_565(new_x, field -> y - h + size, old_x - new_x, h, field -> bg);
+	}
+
+	field -> last[i] = '\0';
+	field -> valid = 1;
+	PERF_END(PERF_LCD_TEXT_FIELD);
+}
+
+void LCD_Scroll_Define(uint16_t top, uint16_t lines)
+{
+	uint16_t bottom = LCD_SCROLL_LINES - top - lines;
+	LCD_Command(VSCRDEF);
+	LCD_Data_8(top >> 8);
+	LCD_Data_8(top & 0xFF);
+	LCD_Data_8(lines >> 8);
+	LCD_Data_8(lines & 0xFF);
+	LCD_Data_8(bottom >> 8);
+	LCD_Data_8(bottom & 0xFF);
+}
+
+void LCD_Scroll_Start(uint16_t line)
+{
+	LCD_Command(VSCRSADD);
+	LCD_Data_8(line >> 8);
+	LCD_Data_8(line & 0xFF);
+}
+
+void LCD_Wave_Init(LCD_Wave *wave, uint16_t top, uint16_t lines, uint8_t decimation, uint32_t color24, uint32_t bg24)
+{
+	wave -> top = top;
+	wave -> lines = lines;
+	wave -> color = H24_RGB565(0, color24);
+	wave -> bg = H24_RGB565(0, bg24);
+	wave -> decimation = decimation ? decimation : 1;
+	LCD_Scroll_Define(top, lines);
+	LCD_Wave_Clear(wave);
+}
+
+void LCD_Wave_Clear(LCD_Wave *wave)
+{
+	wave -> head = 0;
+	wave -> skip = 0;
+	wave -> valid = 0;
+	LCD_Scroll_Start(wave -> top);
+	LCD_Rect_Fill_565(0, wave -> top, LCD_WAVE_WIDTH, wave -> lines, wave -> bg);
+}
+
+void LCD_Wave_Push(LCD_Wave *wave, int32_t value)
+{
+	if (!wave -> valid)
+	{
+		wave -> lo = value - LCD_WAVE_MIN_SPAN / 2;
+		wave -> hi = value + LCD_WAVE_MIN_SPAN / 2;
+	}
+
+	// Envelope: expands at once, relaxes towards the signal by 1/256 per sample
+	if (value < wave -> lo) wave -> lo = value;
+	else wave -> lo += (value - wave -> lo) >> 8;
+	if (value > wave -> hi) wave -> hi = value;
+	else wave -> hi -= (wave -> hi - value) >> 8;
+
+	if (wave -> valid && ++wave -> skip < wave -> decimation) return;
+	wave -> skip = 0;
+
+	int32_t span = wave -> hi - wave -> lo;
+	if (span < LCD_WAVE_MIN_SPAN)
+	{
+		int32_t mid = wave -> lo + span / 2;
+		wave -> lo = mid - LCD_WAVE_MIN_SPAN / 2;
+		wave -> hi = wave -> lo + LCD_WAVE_MIN_SPAN;
+		span = LCD_WAVE_MIN_SPAN;
+	}
+	uint8_t x = (uint8_t) ((value - wave -> lo) * (LCD_WAVE_WIDTH - 1) / span);
+	if (!wave -> valid) wave -> last_x = x;
+
+	// Joins the previous sample so steep edges stay continuous
+	uint8_t a = x < wave -> last_x ? x : wave -> last_x;
+	uint8_t b = x < wave -> last_x ? wave -> last_x : x;
+	LCD_Stream_Begin(0, wave -> top + wave -> head, LCD_WAVE_WIDTH, 1);
+	LCD_Stream_Color(wave -> bg, a);
+	LCD_Stream_Color(wave -> color, b - a + 1);
+	LCD_Stream_Color(wave -> bg, LCD_WAVE_WIDTH - 1 - b);
+	LCD_Stream_End();
+
+	// The row just painted becomes the last one shown in the band
+	if (++wave -> head >= wave -> lines) wave -> head = 0;
+	LCD_Scroll_Start(wave -> top + wave -> head);
+
+	wave -> last_x = x;
+	wave -> valid = 1;
 }
 
 void LCD_Bitmap(uint16_t x, uint16_t y, PGM_P bitmap)
@@ -429,23 +746,22 @@ void LCD_Bitmap(uint16_t x, uint16_t y, PGM_P bitmap)
 	bitmap += 2;
 	uint8_t h = pgm_read_word(bitmap);
 	bitmap += 2;
-	LCD_Window(x, y, x + w - 1, y + h - 1);
+	LCD_Stream_Begin(y, x, h, w);
 	for (uint16_t i = 0; i < h; i++)
 	{
-		for (uint16_t j = 0; j < w; j++)
-		{
-			uint16_t color = pgm_read_word(bitmap);
-			LCD_Data_16(color);
-			bitmap += 2;
-		}
+		LCD_Stream_Push_P((const uint16_t *) bitmap, w);
+		bitmap += 2 * w;
 	}
+	LCD_Stream_End();
 }
 
 void LCD_Bitmap_Mono(uint16_t x, uint16_t y, PGM_P bitmap, uint32_t color24_set, uint32_t color24_unset)
 {
 	uint8_t w = pgm_read_byte(bitmap++);
 	uint8_t h = pgm_read_byte(bitmap++);
-	LCD_Window(x, y, x + w - 1, y + h - 1);
+	uint16_t color_set = H24_RGB565(0, color24_set);
+	uint16_t color_unset = H24_RGB565(0, color24_unset);
+	LCD_Stream_Begin(y, x, h, w);
 	uint16_t bit_pos = 0;
 	uint16_t byte = 0;
 	for (uint16_t i = 0; i < h; i++)
@@ -453,11 +769,11 @@ void LCD_Bitmap_Mono(uint16_t x, uint16_t y, PGM_P bitmap, uint32_t color24_set,
 		for (uint16_t j = 0; j < w; j++)
 		{
 			if (bit_pos % 8 == 0) byte = pgm_read_byte(bitmap++);
-			if (byte & (1 << (bit_pos % 8))) LCD_Data_16(H24_RGB565(0, color24_set));
-			else LCD_Data_16(H24_RGB565(0, color24_unset));
+			LCD_Stream_Color((byte & (1 << (bit_pos % 8))) ? color_set : color_unset, 1);
 			bit_pos++;
 		}
 	}
+	LCD_Stream_End();
 }
 
 void LCD_SPI(void)
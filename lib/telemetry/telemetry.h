@@ -0,0 +1,55 @@
+//!
+//! \file           telemetry.h
+//! \brief          Telemetria binaria das amostras cruas do MAX30102 via USART
+//! \author         Paulo Donizete Antunes Junior
+//! \date           2025-08-10
+//! \version        1.0
+//! \details        Quadros COBS delimitados por 0x00, com CRC-8 e amostras de
+//!                 18 bits empacotadas. Formato do quadro (antes do COBS):
+//!
+//!                 [tipo u8][seq u16 LE][n u8][n x (RED 18b, IR 18b) MSB primeiro][crc8]
+//!
+//!                 seq e o indice (modulo 2^16) da primeira amostra do quadro,
+//!                 o que permite ao decodificador contar amostras perdidas.
+//!                 O CRC-8 (polinomio 0x07, valor inicial 0x00) cobre do tipo
+//!                 ao ultimo byte de amostras.
+//!
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+
+// =============================================================================
+// Formato do quadro (compartilhado com tools/telemetry_decoder.cpp)
+// =============================================================================
+
+#define TELEMETRIA_TIPO_AMOSTRAS        0x01
+#define TELEMETRIA_AMOSTRAS_POR_QUADRO  8
+#define TELEMETRIA_CABECALHO            4       // tipo + seq + n
+#define TELEMETRIA_BYTES_AMOSTRAS(n)    (((n) * 36 + 7) / 8)
+#define TELEMETRIA_QUADRO_MAX           (TELEMETRIA_CABECALHO + \
+                                         TELEMETRIA_BYTES_AMOSTRAS(TELEMETRIA_AMOSTRAS_POR_QUADRO) + 1)
+#define TELEMETRIA_CRC8_POLY            0x07
+
+// CRC-8 (polinomio 0x07) usado no fim de cada quadro
+uint8_t telemetriaCrc8(const uint8_t* data, uint8_t len);
+
+// Zera o contador de sequencia e descarta o quadro em montagem
+void telemetriaReset(void);
+
+// Acrescenta uma amostra crua; o quadro e enviado ao completar
+// TELEMETRIA_AMOSTRAS_POR_QUADRO amostras
+void telemetriaAmostra(uint32_t red, uint32_t ir);
+
+// Envia o quadro parcial, se houver
+void telemetriaFlush(void);
+
+// n amostras perdidas no sensor: fecha o quadro atual e avanca seq, e o
+// decodificador conta a lacuna como nas perdas da USART
+void telemetriaLacuna(uint8_t n);
+
+// Quadros descartados por falta de espaco no buffer da USART
+uint16_t telemetriaQuadrosPerdidos(void);
+
+#endif // TELEMETRY_H
@@ -0,0 +1,117 @@
+#include "telemetry.h"
+#include "../hal/hal.h"
+
+// Quadro em montagem (sem COBS)
+static uint8_t  quadro[TELEMETRIA_QUADRO_MAX];
+static uint8_t  quadroAmostras = 0;
+static uint8_t  quadroBytes    = TELEMETRIA_CABECALHO;
+static uint16_t quadroSeq      = 0;
+static uint16_t quadrosPerdidos = 0;
+
+// Bits ainda nao alinhados em byte durante o empacotamento de 18 bits
+static uint32_t bitsPendentes  = 0;
+static uint8_t  nBitsPendentes = 0;
+
+uint8_t telemetriaCrc8(const uint8_t* data, uint8_t len) {
+    uint8_t crc = 0x00;
+
+    while (len--) {
+        crc ^= *data++;
+        for (uint8_t i = 0; i < 8; i++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ TELEMETRIA_CRC8_POLY) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// Escreve os 18 bits menos significativos de valor, MSB primeiro
+static void empacota18(uint32_t valor) {
+    bitsPendentes = (bitsPendentes << 18) | (valor & 0x03FFFF);
+    nBitsPendentes += 18;
+    while (nBitsPendentes >= 8) {
+        nBitsPendentes -= 8;
+        quadro[quadroBytes++] = (uint8_t)(bitsPendentes >> nBitsPendentes);
+    }
+}
+
+// Codifica o quadro em COBS direto no buffer da USART, entre dois delimitadores 0x00.
+// O delimitador inicial separa o quadro de qualquer texto de printf que o preceda.
+static void enviaQuadro(uint8_t len) {
+    // Pior caso: 1 byte de codigo extra (quadro < 254 bytes) + 2 delimitadores
+    uint8_t total = len + 3;
+
+    // Sem espaco e sem como esperar (interrupcoes desligadas): descarta o quadro inteiro
+    if (!hal_serial_espaco(total)) {
+        if (quadrosPerdidos != 0xFFFF) {
+            quadrosPerdidos++;
+        }
+        return;
+    }
+
+    hal_serial_envia(0x00);
+    uint8_t inicio = 0;
+    while (inicio <= len) {
+        // Bloco ate o proximo zero (ou fim do quadro)
+        uint8_t fim = inicio;
+        while (fim < len && quadro[fim] != 0x00) {
+            fim++;
+        }
+        hal_serial_envia((uint8_t)(fim - inicio + 1));
+        for (uint8_t i = inicio; i < fim; i++) {
+            hal_serial_envia(quadro[i]);
+        }
+        inicio = fim + 1;
+    }
+    hal_serial_envia(0x00);
+}
+
+void telemetriaReset(void) {
+    quadroAmostras = 0;
+    quadroBytes    = TELEMETRIA_CABECALHO;
+    quadroSeq      = 0;
+    bitsPendentes  = 0;
+    nBitsPendentes = 0;
+}
+
+void telemetriaFlush(void) {
+    if (quadroAmostras == 0) {
+        return;
+    }
+
+    // Completa o ultimo byte (n impar deixa 4 bits pendentes)
+    if (nBitsPendentes) {
+        quadro[quadroBytes++] = (uint8_t)(bitsPendentes << (8 - nBitsPendentes));
+        nBitsPendentes = 0;
+    }
+
+    quadro[0] = TELEMETRIA_TIPO_AMOSTRAS;
+    quadro[1] = (uint8_t)(quadroSeq);
+    quadro[2] = (uint8_t)(quadroSeq >> 8);
+    quadro[3] = quadroAmostras;
+    quadro[quadroBytes] = telemetriaCrc8(quadro, quadroBytes);
+
+    enviaQuadro(quadroBytes + 1);
+
+    quadroSeq     += quadroAmostras;
+    quadroAmostras = 0;
+    quadroBytes    = TELEMETRIA_CABECALHO;
+    bitsPendentes  = 0;
+}
+
+void telemetriaLacuna(uint8_t n) {
+    telemetriaFlush();
+    quadroSeq += n;
+}
+
+void telemetriaAmostra(uint32_t red, uint32_t ir) {
+    empacota18(red);
+    empacota18(ir);
+
+    if (++quadroAmostras >= TELEMETRIA_AMOSTRAS_POR_QUADRO) {
+        telemetriaFlush();
+    }
+}
+
+uint16_t telemetriaQuadrosPerdidos(void) {
+    return quadrosPerdidos;
+}
@@ -14,61 +14,72 @@
 #include "../lib/funsape/peripheral/funsapeLibTimer0.hpp"
 #include "../lib/MAX30102/MAX30102.h"
 #include "../lib/TWI/twi_master.h"
-#include "../lib/MAX30102/calcMaster.h"
-#include "../lib/st7735/st7735.h"
-#include "../fonts/Font_8_Retro.h"
+#include "../lib/medicao/medicao.h"
+#include "../lib/hal/hal.h"
+#include "../lib/telemetry/telemetry.h"
+#include "../lib/sched/sched.h"
+#include "../lib/power/power.h"
+#include "../lib/buzzer/buzzer.h"
+
+#include <avr/pgmspace.h>
 
 //====================================
 // Variaveis de controle
 //====================================
 
 // var de controle de int
-volatile bool fifo_rdy        = 0;
-volatile bool bpm_rdy         = 0;
 volatile bool debug_rdy       = 0;
 
-// Var de remocao de ruidos e triangulição de ruidos
-uint32_t tendeciaIr[3];
-uint8_t  controle        = 16;
-uint8_t  tendeciaIrIndex = 0;
+// Eventos do escalonador, em ordem de prioridade (0 = maior)
+enum {
+    EV_SENSOR = 0,      // FIFO do MAX30102 quase cheia ou drenagem em andamento
+    EV_BOTAO,           // INT1 confirmado pelo debounce
+    EV_DISPLAY,         // modo ou campos da tela a redesenhar
+    EV_TELEMETRIA,      // fluxo de telemetria parado com quadro parcial
+    EV_TEMPERATURA,     // hora de uma nova conversao de temperatura do die
+    EV_TOTAL
+};
+
+// Ticks de 0.5 ms para n amostras na taxa de saida da FIFO (62.5 sps: 32 ticks cada)
+#define AMOSTRAS_TICKS(n)   ((uint16_t)((uint32_t)(n) * 2000000UL / MAX30102_PADRAO_TAXA_EFETIVA_MHZ))
+
+// Quadro parcial da telemetria sai apos dois blocos sem amostras (um bloco de
+// A_FULL amostras chega a cada 272 ms)
+#define TELEMETRIA_OCIOSA   AMOSTRAS_TICKS(2 * MAX30102_PADRAO_A_FULL)
 
-// var de buffer utilizado para cal do bpm
-uint32_t bpmAmostra[MAXVALUES];
-uint16_t bpmIndex = 0;
-const uint32_t tamanho = sizeof(bpmAmostra) / sizeof(bpmAmostra[0]);
-uint16_t indices_vales[MAXVALUES];
+// Temperatura do die a cada 30 s com dedo (e na chegada do dedo): o die esquenta
+// devagar, e cada conversao custa duas transacoes I2C curtas
+#define TEMPERATURA_PERIODO 60000
+
+// Partes pendentes do redesenho (tarefaDisplay faz uma por execucao)
+static bool modoPendente     = false;
+static bool medidasPendentes = false;
+
+// Cada bloco da FIFO: presenca, Oximetro, ganho, temperatura e telemetria
+// (o mesmo processamento que tools/replay roda no PC)
+Medicao medicao;
 
 // var de buffer utilizado para exibição bpm e checagem em caso de bpm igual.
 volatile uint16_t bpm_parte_int = 0;
 volatile uint16_t bpm_parte_dec = 0;
 volatile uint16_t last_bpm_parte_int = 0;
 volatile uint16_t last_bpm_parte_dec = 0;
-
-//buffer usado para escrita na tela
-char str[40];
+volatile uint16_t spo2_x100 = 0;
+volatile uint16_t last_spo2_x100 = 0;
 
 //Timer0 var
 volatile bool aguardandoDebounce = false;
 volatile uint8_t debounceCounter = 0;
 
-// Buzzer variavel
-static uint8_t totalBips = 0;
-static uint8_t currentBips = 0;
-static uint16_t counter = 0;
-static bool state = false;
-static bool modoContinuo = false;
-#define BUZZER_PIN PC0
-
-
 //====================================
-// Buzzer bipes error list
+// Padroes do buzzer (lib/buzzer)
 //====================================
 
-/*
-4 - Falha na inicializacao
-0 - ativa modo continuo
-1 - desativa modo continuo
-*/
+// { bips, prioridade, ligado ms, desligado ms }; o bipe de batimento tem a mesma
+// prioridade do alarme para encerra-lo quando o bpm volta a faixa
+static const buzzer_padrao_t BIP_FALHA     PROGMEM = { 4, 3, 100, 250 };   // falha na inicializacao
+static const buzzer_padrao_t BIP_ALARME    PROGMEM = { 0, 2,  50,  50 };   // bpm fora da faixa (continuo)
+static const buzzer_padrao_t BIP_BATIMENTO PROGMEM = { 1, 2, 100, 250 };   // bpm na faixa
 
 //====================================
 // Funcoes presentes na main
@@ -76,17 +87,29 @@ static bool modoContinuo = false;
 
 void usartConfg(void); // Habilita usart
 
-void processaBPM(volatile uint16_t* parte_int,
-                       volatile uint16_t* parte_dec); // 1) Faz a aquisicao da FIFO, trata o dado e calcula
+void processaBPM(const max30102Sample_t* amostras,
+                 uint8_t available,
+                 volatile uint16_t* parte_int,
+                 volatile uint16_t* parte_dec);       // 1) Trata as amostras drenadas da FIFO e calcula
                                                       // bpm e retorna o mesmo em duas partes
                                                       // 2) Quando debug for ativo também faz a insercao de
                                                       // de dados de IR e RED
 
-void picIfsc(void);                                   // setup inicial do display + modo de debug
-
-void buzzerSignal(uint8_t bips);                      //Controle do buzzer com base no tempo
-
-void buzzerTick();                                    //....
+void tarefaSensor(void);                              // Drena a FIFO e processa o bloco
+void tarefaBotao(void);                               // Alterna o modo debug
+void tarefaDisplay(void);                             // Redesenha modo e campos, em partes
+void tarefaTelemetria(void);                          // Envia o quadro parcial da telemetria
+void tarefaTemperatura(void);                         // Pede a proxima conversao de temperatura
+
+// Prazos em ticks de 0.5 ms. A_FULL com 17 de 32 amostras deixa 15 amostras
+// (240 ms) ate o rollover comecar a descartar amostras.
+static const sched_evento_t eventos[EV_TOTAL] = {
+    { tarefaSensor,     AMOSTRAS_TICKS(MAX30102_FIFO_SIZE - MAX30102_PADRAO_A_FULL) },
+    { tarefaBotao,      20 },               // 10 ms
+    { tarefaDisplay,    200 },              // 100 ms
+    { tarefaTelemetria, SCHED_SEM_PRAZO },
+    { tarefaTemperatura, SCHED_SEM_PRAZO },
+};
 
 //====================================
 // Fim das funcoes presentes na main
@@ -95,12 +118,16 @@ void buzzerTick();                                    //....
 int main(void)
 {
     usartConfg(); // Inicia com usart habilitada
+    power_init(); // ADC, comparador, Timer1 e Timer2 desligados
+    sched_init(eventos, EV_TOTAL);
     sei();
 
     printf("[01] Programa iniciando ----- \r\n");
     printf("[02] Uart     iniciado  ----- \r\n");
     printf("[03] Interrup habilitadas ----- \r\n");
 
+    buzzer_init(); // Timer2 so roda enquanto um padrao toca
+
     //init1 para habilitacao de debug_rdy;
     setBit(PORTD, PD3);
     int1.init(Int1::SenseMode::FALLING_EDGE);
@@ -108,29 +135,26 @@ int main(void)
     int1.activateInterrupt();
     printf("[04] INT1     configurado ----- \r\n");
 
-    //Init display tft e SPI
-    LCD_Init(2, 3);
+    //Init display tft e SPI + logo do ifsc, nome do autor e campos
+    hal_display_init();
     printf("[05] Display  iniciado  ----- \r\n");
-
-    LCD_Rect_Fill(0, 0, 160, 128, BLACK);
-    picIfsc(); // Desenha logo do ifsc + o nome do autor
     printf("[06] Tela     inicial    ----- \r\n");
 
+    //timer init config (antes do MAX30102: tw_tick limita o tempo das transacoes I2C)
+    timer0.init(Timer0::Mode::CTC_OCRA, Timer0::ClockSource::PRESCALER_64);
+    timer0.setCompareAValue(125); // 0.5ms
+    timer0.clearCompareAInterruptRequest();
+    timer0.activateCompareAInterrupt();
+    printf("[07] TIMER0   iniciado  ----- \r\n");
+
     //init MAX30102 e TWI
     if (!initMAX30102()) {
         printf("-=01=- MAX30102 falhou     ----- \r\n");
-        buzzerSignal(4);
+        buzzer_toca(&BIP_FALHA);
         while(1);
     }
 
-    printf("[07] MAX30102 iniciado  ----- \r\n");
-
-    //timer init config
-    timer0.init(Timer0::Mode::CTC_OCRA, Timer0::ClockSource::PRESCALER_64);
-    timer0.setCompareAValue(125); // 0.5ms
-    timer0.clearCompareAInterruptRequest();
-    timer0.activateCompareAInterrupt();
-    printf("[08] TIMER0   iniciado  ----- \r\n");
+    printf("[08] MAX30102 iniciado  ----- \r\n");
 
     //init0 usado pelo MAX30102 para leitura da FIFO interna;
     setBit(PORTD, PD2);
@@ -139,47 +163,18 @@ int main(void)
     int0.activateInterrupt();
     printf("[09] INT0     configurado ----- \r\n");
 
+    sched_agenda(EV_TEMPERATURA, TEMPERATURA_PERIODO);
 
-    while (1) {
-        if(fifo_rdy){
-            processaBPM(&bpm_parte_int, &bpm_parte_dec);
-            printf("[10] BPM processado ----- \r\n");
-
-            // Garante a exibição de um bpm novo sempre
-            if(bpm_parte_int != last_bpm_parte_int || bpm_parte_dec != last_bpm_parte_dec){
-                printf("[11.1] Antigo bpm defasado ----- \r\n");
-
-                last_bpm_parte_dec = bpm_parte_dec;
-                last_bpm_parte_int = bpm_parte_int;
 
-                if(last_bpm_parte_dec >= 150 || last_bpm_parte_dec <= 40){
-                    buzzerSignal(0);
-                }else{
-                    buzzerSignal(1);
-                }
-
-                bpm_rdy = true;
-            }
-        }
-
-        if(bpm_rdy == true){
-            // Atualiza os dados exibidos no display
-            printf("[12] BPM exibido ----- \r\n");
-            snprintf(str, 40, "BPM: %u.%02u\n\r", bpm_parte_int, bpm_parte_dec);
-            LCD_Rect_Fill(65, 54, 52, 16, BLACK);
-            LCD_Font(28, 70, str, _8_Retro, 1, WHITE);
-
-            bpm_rdy = false;
-        }
-    }
-
-    return 0;
+    // Daqui em diante tudo roda por eventos; sem eventos a CPU dorme
+    sched_laco();
 }
 
 // Faz a leitura do pulso enviado por max30102 indicando FIFO_RDY.
 void int0InterruptCallback(void)
 {
-    fifo_rdy = true;
+    hal_sensor_pedido();
+    sched_posta(EV_SENSOR);
 }
 
 // ativacao de modeo de debug
@@ -191,17 +186,14 @@ void int1InterruptCallback(void){
 
 }
 
-// Faz o controle de repique de INT1 + temporizacao do sinal enviado pelo buzzer
+// Faz o controle de repique de INT1 + bases de tempo
 void timer0CompareACallback(void){
     //int1 configuration validation
         if (aguardandoDebounce) {
         if (isBitClr(PIND, PD3)) {
             debounceCounter++;
             if (debounceCounter >= 4) { // 4 * 0,5ms = 2ms
-                debug_rdy = !debug_rdy;
-                printf("[XX] DEBUG TOGGLE\r\n");
-                printf("     debug_rdy [%d]\r\n", debug_rdy);
-                picIfsc();
+                sched_posta(EV_BOTAO);
 
                 aguardandoDebounce = false;
                 debounceCounter = 0;
@@ -213,207 +205,164 @@ void timer0CompareACallback(void){
         }
     }
 
-    //Habilita tempo proprio para o buzzer
-    buzzerTick();
-}
-
-// Coracao do projeto leia as analises a baixo para mais detalhe
-void processaBPM(volatile uint16_t* parte_int, volatile uint16_t* parte_dec) {
-
-        // le reg interno do max entendimento de quantas amostras estao pronta
-        uint8_t available = getAvailableSamples();
-
-        if (available > 0) {
-            fifo_rdy = false;
-
-            for (uint8_t i = 0; i < available; i++) {
-                uint32_t red = 0, ir = 0;
-                uint32_t irMedia = 0;
-
-                // media entres as amostras coletas
-                // Preferi pela amostra via software
-                // devido a lentidao quando feita via periferico
-
-                for (uint8_t j = 0; j < controle; j++) {
-                    readFIFO(&red, &ir);
-                    irMedia += ir;
-
-                }
-
-                if(debug_rdy){
-                printf("RED: %lu \t IR: %lu\r\n", red, ir);
-                }
-
-                // Tratamento de dado para reducao de ruidos
-                irMedia /= controle;
-                tendeciaIr[tendeciaIrIndex++] = irMedia;
-
-                if (tendeciaIrIndex == 3) {
-                    tendeciaIrIndex = 0;
-                    uint32_t retorno1 = calcularTendencia(tendeciaIr);
-
-                    for (uint8_t k = 0; k < 3; k++)
-                        tendeciaIr[k] = 0;
-
-                    // verifica se há um dedo no sensor
-                    if (retorno1 > 5000) {
-                        // guarda a amostra para calculo posterior de bpm
-                        bpmAmostra[bpmIndex++] = retorno1;
-                    }
-
-                    // se bpmAmostra esta cheio inicia o calculo
-                    if (bpmIndex >= tamanho) {
-
-                        // O calculo se baseia na detecao de vales devido a maior facilidade de detecao
-                        // 1 o codigo faz uma media das 10 maiores variacoes do sentido cima baixo de IR
-                        // Com isso temos uma nocao de quando ha realmente um vale e permitindo uma alto calibragem.
-                        // 2 parte ele faz a diferenca entre esses vales com base na frequencia de amostra de
-                        // (62.5f) e faz a media entre elas e procede para calcular e retornar bpm.
-
-                        bpmIndex = 0;
-                        float bpm = detectarValesEBPM(
-                        bpmAmostra, tamanho, indices_vales, 10);
-                        *parte_int = (uint16_t)bpm;
-                        *parte_dec = (uint16_t)((bpm - *parte_int) * 100);
+    //Base de tempo dos timeouts do TWI
+    tw_tick();
 
-                        if(debug_rdy == 1){
-                            LCD_Orientation(0, 2);
-                            LCD_Rect_Fill(65, 71, 52, 32, BLACK);
-                            snprintf(str, 40, "RED: %u\n\r", red);
-                            LCD_Font(28, 87, str, _8_Retro, 1, BLUE);
-                            snprintf(str, 40, "IR:  %u\n\r", ir);
-                            LCD_Font(28, 103, str, _8_Retro, 1, WHITE);
-                        }
+    //Base de tempo da HAL
+    hal_tick();
 
-                    }
-                }
-            }
-
-
-
-            readRegister(MAX30102_INT_STATUS_1);
-            readRegister(MAX30102_INT_STATUS_2);
-            int0.clearInterruptRequest();
-        }
-}
+    //Agendamentos e prazos do escalonador
+    sched_tick();
 
-//usart config
-void usartConfg(void){
-    usart0.setBaudRate(Usart0::BaudRate::BAUD_RATE_57600);
-    usart0.init();
-    usart0.enableTransmitter();
-    usart0.stdio();
+    //Janela de medicao do ciclo ativo
+    power_tick();
 }
 
-// imagem inicial do simbolo ifsc e nome com o nome do autor
-void picIfsc(void){
-
-    uint32_t color;
-
-    if(debug_rdy == 1){
-        color = BLUE;
-
-        LCD_Orientation(0, 2);
-        snprintf(str, 40, "RED: %u\n\r", 0);
-        LCD_Rect_Fill(65, 71, 52, 32, BLACK);
-        LCD_Font(28, 87, str, _8_Retro, 1, WHITE);
-        snprintf(str, 40, "IR:  %u\n\r", 0);
-        LCD_Font(28, 103, str, _8_Retro, 1, WHITE);
-
-    }else{
-        color = LIME;
+// Sensor: inicia a drenagem, acompanha o TWI e processa o bloco
+void tarefaSensor(void)
+{
+    uint8_t available;
+    const max30102Sample_t* amostras = hal_sensor_bloco(&available);
 
-        LCD_Orientation(0, 2);
-        LCD_Rect_Fill(28, 71, 52, 32, BLACK);
+    if (amostras == NULL) {
+        // Drenagem correndo por TWI_vect: confere de novo no proximo tick
+        if (hal_sensor_ocupado()) {
+            sched_agenda(EV_SENSOR, 1);
+        }
+        return;
     }
 
-    // Bloco usado para desenhar simbolo do ifsc ---------------------------------
-
-    LCD_Orientation(0, 3);
-
-    LCD_Circle(8, 118, 4, 1, 1, RED);
+    // FIFO vazia ou falha no I2C: a HAL refez o pedido
+    if (hal_sensor_ocupado()) {
+        sched_posta(EV_SENSOR);
+    }
 
-    //Linha 1
-    LCD_Rect_Fill(4, 101, 9, 9, color);
-    LCD_Rect_Fill(4, 87, 9, 9, color);
+    // Falha no I2C (timeout/NACK) ja recuperada pelo driver: a FIFO e lida de novo
+    if(hal_sensor_status() != SUCCESS && debug_rdy){
+        printf("-=02=- I2C erro 0x%03X ----- \r\n", hal_sensor_status());
+    }
 
-    //Linha 2
-    LCD_Rect_Fill(15, 114, 9, 9, color);
-    LCD_Rect_Fill(15, 101, 9, 9, color);
+    processaBPM(amostras, available, &bpm_parte_int, &bpm_parte_dec);
+    printf("[10] BPM processado ----- \r\n");
 
-    //Linha 3
-    LCD_Rect_Fill(27, 114, 9, 9, color);
-    LCD_Rect_Fill(27, 101, 9, 9, color);
-    LCD_Rect_Fill(27,  87, 9, 9, color);
+    // Garante a exibição de um bpm novo sempre
+    if(bpm_parte_int != last_bpm_parte_int || bpm_parte_dec != last_bpm_parte_dec){
+        printf("[11.1] Antigo bpm defasado ----- \r\n");
 
-    //Linha 4
-    LCD_Rect_Fill(39, 114, 9, 9, color);
-    LCD_Rect_Fill(39, 101, 9, 9, color);
+        last_bpm_parte_dec = bpm_parte_dec;
+        last_bpm_parte_int = bpm_parte_int;
 
-    //---------------------------------------------------------------------------
+        if(last_bpm_parte_int >= 150 || last_bpm_parte_int <= 40){
+            buzzer_toca(&BIP_ALARME);
+        }else{
+            buzzer_toca(&BIP_BATIMENTO);
+        }
 
-    LCD_Orientation(0, 2);
+        medidasPendentes = true;
+    }
 
-    // Escola + autor
-    LCD_Font(48, 18, "-=IFSC=-", _8_Retro, 1, WHITE);
-    LCD_Font(48, 36, "Paulo", _8_Retro, 1, WHITE);
+    if(spo2_x100 != last_spo2_x100){
+        last_spo2_x100 = spo2_x100;
+        medidasPendentes = true;
+    }
 
-    // Inicializa bpm na tela
-    snprintf(str, 40, "BPM: %u.%02u\n\r", 0, 0);
-    LCD_Rect_Fill(65, 54, 52, 16, BLACK);
-    LCD_Font(28, 70, str, _8_Retro, 1, WHITE);
+    if (medidasPendentes) {
+        sched_posta(EV_DISPLAY);
+    }
 
+    // Enquanto chegam amostras o quadro parcial espera; o envio fica para quando o fluxo parar
+    if (debug_rdy && available) {
+        sched_agenda(EV_TELEMETRIA, TELEMETRIA_OCIOSA);
+    }
 }
 
-void buzzerSignal(uint8_t bips) {
-    totalBips = (bips > 8) ? 8 : bips;
-    currentBips = 0;
-    counter = 0;
-    state = 0;
+// Botao (INT1 ja sem repique): alterna o modo debug
+void tarefaBotao(void)
+{
+    debug_rdy = !debug_rdy;
+    printf("[XX] DEBUG TOGGLE\r\n");
+    printf("     debug_rdy [%d]\r\n", debug_rdy);
+    printf("     tx perdidos [%u]\r\n", usart0.getTransmissionDroppedCount());
+    printf("     sensor atrasos [%u] latencia max [%u] perdidas [%lu]\r\n",
+           sched_atrasos(EV_SENSOR), sched_latencia_max(EV_SENSOR),
+           (unsigned long)max30102PerdidasTotal());
+    printf("     LED red [%u] ir [%u] faixa [%u nA]\r\n",
+           medicao.ganho().paRed(), medicao.ganho().paIr(), medicao.ganho().faixaNa());
+    printf("     die [%d/16 C] SpO2 A [%u] B [%u]\r\n", medicao.temperaturaQ4(),
+           medicao.oximetro().spo2().coefAx100(), medicao.oximetro().spo2().coefBx100());
+    printf("     ciclo ativo [%u.%02u%%]\r\n",
+           power_ciclo_ativo_x100() / 100, power_ciclo_ativo_x100() % 100);
+
+    modoPendente = true;
+    sched_posta(EV_DISPLAY);
+}
 
-    if(bips == 0){
-        modoContinuo = true;
-    }else{
-        modoContinuo = false;
+// Display: uma parte por execucao, para a FIFO do sensor passar na frente
+// entre o redesenho do modo e o dos campos
+void tarefaDisplay(void)
+{
+    if (modoPendente) {
+        modoPendente = false;
+        hal_display_modo(debug_rdy);
+        if (medidasPendentes) {
+            sched_posta(EV_DISPLAY);
+        }
+        return;
     }
 
-    if(bips == 1){
-        modoContinuo = false;
+    if (medidasPendentes) {
+        // Atualiza os dados exibidos no display
+        printf("[12] BPM exibido ----- \r\n");
+        hal_display_medidas(bpm_parte_int * 100 + bpm_parte_dec, spo2_x100);
+        medidasPendentes = false;
     }
+}
 
-    setBit(DDRC,  BUZZER_PIN);     // Garante como saída
-    clrBit(PORTC, BUZZER_PIN);    // Começa desligado
+// Telemetria: fluxo parado (saida do modo debug ou sensor sem amostras)
+void tarefaTelemetria(void)
+{
+    telemetriaFlush();
 }
 
-// calculo de On/off de buzzer com base no timer0 em 0,5ms
-void buzzerTick() {
-    counter++;
-
-    if (modoContinuo) {
-        if (counter >= 100) { // 50ms ON/OFF
-            counter = 0;
-            state = !state;
-            if (state)
-                setBit(DDRC, BUZZER_PIN);
-            else
-                clrBit(PORTC, BUZZER_PIN);
-        }
-        return;
-    }
+// Temperatura: so marca o pedido; tarefaSensor inicia a conversao entre dois blocos
+void tarefaTemperatura(void)
+{
+    medicao.pedeTemperatura();
+    sched_agenda(EV_TEMPERATURA, TEMPERATURA_PERIODO);
+}
 
-    if (totalBips == 0) return;
+// Coracao do projeto: o processamento do bloco esta em lib/medicao (e a analise
+// do sinal em lib/MAX30102/oximetro); aqui ficam as medidas exibidas e o buzzer
+void processaBPM(const max30102Sample_t* amostras, uint8_t available, volatile uint16_t* parte_int, volatile uint16_t* parte_dec) {
+
+        uint8_t eventos = medicao.bloco(amostras, available, debug_rdy);
+
+        if (eventos & MEDICAO_SAIU) {
+            // Medidas zeradas na tela; os last_* juntos para 0 bpm nao soar o alarme
+            *parte_int = 0;
+            *parte_dec = 0;
+            spo2_x100  = 0;
+            last_bpm_parte_int = 0;
+            last_bpm_parte_dec = 0;
+            last_spo2_x100     = 0;
+            medidasPendentes   = true;
+            buzzer_para(2);
+        }
 
-    if (state && counter >= 200) { // ON por 100ms
-        state = false;
-        clrBit(PORTC, BUZZER_PIN);
-        counter = 0;
-        currentBips++;
-        if (currentBips >= totalBips) {
-            totalBips = 0; // fim
+        if (eventos & MEDICAO_BATIMENTO) {
+            uint16_t bpm_x100 = medicao.bpmX100();
+            *parte_int = bpm_x100 / 100;
+            *parte_dec = bpm_x100 % 100;
+            spo2_x100  = medicao.spo2X100();
         }
-    } else if (!state && counter >= 500) { // OFF por 250ms
-        state = true;
-        setBit(PORTC, BUZZER_PIN);
-        counter = 0;
-    }
+}
+
+//usart config
+void usartConfg(void){
+    // 1 Mbaud (U2X, UBRR = 1, erro 0% em 16 MHz): folga para a telemetria mesmo a 1000 sps
+    usart0.setBaudRate(Usart0::BaudRate::BAUD_RATE_1000000);
+    usart0.setMode(Usart0::Mode::ASYNCHRONOUS_DOUBLE_SPEED);
+    usart0.init();
+    usart0.enableTransmitter();
+    usart0.stdio();
 }
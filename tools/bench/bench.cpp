@@ -0,0 +1,331 @@
+//!
+//! \file           bench.cpp
+//! \brief          Benchmark de precisao e custo dos algoritmos de calcMaster (PC)
+//! \author         Paulo Donizete Antunes Junior
+//! \date           2025-08-16
+//! \version        1.0
+//! \details        Gera PPG sintetico (ppg_sintetico.h) para um conjunto de cenarios
+//!                 e passa o mesmo sinal por cada variante do calculo de BPM:
+//!
+//!                 lote-float  buffer de MAXVALUES tendencias + detectarValesEBPM
+//!                             (fluxo original da main)
+//!                 lote-x100   idem com detectarValesEBPMx100
+//!                 streaming   Oximetro (DetectorBatimento + CalculadoraSpO2)
+//!
+//!                 Para cada variante: erro absoluto medio do BPM contra a media
+//!                 verdadeira dos ultimos 4 intervalos RR, fracao de leituras a
+//!                 +-5 BPM, tempo ate a primeira leitura, custo por amostra crua
+//!                 (ns e ciclos do host) e RAM de estado. No fim, custo por chamada
+//!                 de calcularTendencia, da CadeiaPulso e de mediaMaioresVariacoes.
+//!
+//!                 Compilacao:  g++ -O2 -o bench tools/bench/bench.cpp
+//!                                  lib/MAX30102/oximetro_.cpp lib/MAX30102/calcMaster_.cpp
+//!                 Uso:         ./bench [segundos por cenario] [semente]
+//!
+
+#include "ppg_sintetico.h"
+#include "../../lib/MAX30102/oximetro.h"
+#include "../../lib/MAX30102/presenca.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static inline uint64_t ciclos(void) { return __rdtsc(); }
+#else
+static inline uint64_t ciclos(void) { return 0; }
+#endif
+
+static double agoraS(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// O gerador simula o sensor antes da media no chip (GeradorPPG::FS); as variantes
+// reproduzem essa media em software ate SAMPLE_RATE
+static constexpr int DECIMACAO = (int)(GeradorPPG::FS * 1000.0 / SAMPLE_RATE_MHZ + 0.5);
+
+// =============================================================================
+// Variantes
+// =============================================================================
+
+// Entrada comum das variantes em lote: media de DECIMACAO amostras,
+// janela de tendencia e limiar de dedo (PRESENCA_ENTRADA), como no fluxo original
+class EntradaLote {
+public:
+    // Devolve true quando ha uma nova tendencia com dedo em *valor
+    bool push(uint32_t ir, uint32_t* valor) {
+        _soma += ir;
+        if (++_contagem < DECIMACAO) return false;
+        const uint32_t media = _soma / DECIMACAO;
+        _soma = 0;
+        _contagem = 0;
+        _janela[0] = _janela[1];
+        _janela[1] = _janela[2];
+        _janela[2] = media;
+        if (_indice < 2) {
+            _indice++;
+            return false;
+        }
+        *valor = calcularTendencia(_janela);
+        return *valor > PRESENCA_ENTRADA;
+    }
+
+private:
+    uint32_t _soma = 0;
+    uint32_t _janela[3] = {0, 0, 0};
+    uint8_t  _contagem = 0;
+    uint8_t  _indice = 0;
+};
+
+template <bool FLOAT>
+class VarianteLote {
+public:
+    static const char* nome() { return FLOAT ? "lote-float" : "lote-x100"; }
+
+    // Devolve true quando uma leitura nova fica pronta em *bpm
+    bool push(uint32_t red, uint32_t ir, double* bpm, double* spo2) {
+        (void)red;
+        uint32_t valor;
+        if (!_entrada.push(ir, &valor)) return false;
+        _amostras[_indice++] = valor;
+        if (_indice < MAXVALUES) return false;
+        _indice = 0;
+        *spo2 = 0.0;
+#if CALCMASTER_REFERENCIA_FLOAT
+        if (FLOAT) {
+            *bpm = detectarValesEBPM(_amostras, MAXVALUES, _vales, MAXVARDET);
+            return *bpm > 0.0;
+        }
+#endif
+        *bpm = detectarValesEBPMx100(_amostras, MAXVALUES, _vales, MAXVARDET) / 100.0;
+        return *bpm > 0.0;
+    }
+
+    size_t memoria() const { return sizeof(*this); }
+
+private:
+    EntradaLote _entrada;
+    uint32_t    _amostras[MAXVALUES];
+    uint16_t    _vales[MAXVALUES];
+    uint16_t    _indice = 0;
+};
+
+class VarianteStreaming {
+public:
+    static const char* nome() { return "streaming"; }
+
+    bool push(uint32_t red, uint32_t ir, double* bpm, double* spo2) {
+        if (!(_oximetro.push(red, ir) & OXIMETRO_BATIMENTO)) return false;
+        *bpm  = _oximetro.bpmX100() / 100.0;
+        *spo2 = _oximetro.spo2X100() / 100.0;
+        return *bpm > 0.0;
+    }
+
+    size_t memoria() const { return sizeof(*this); }
+
+private:
+    Oximetro _oximetro{DECIMACAO};
+};
+
+// =============================================================================
+// Cenarios e metricas
+// =============================================================================
+
+struct Cenario {
+    const char*   nome;
+    ParametrosPPG p;
+};
+
+struct Sinal {
+    std::vector<uint32_t> red, ir;
+    GeradorPPG*           verdade = nullptr;
+};
+
+struct Resultado {
+    unsigned leituras = 0;
+    double   somaErro = 0.0;
+    unsigned dentro5 = 0;
+    double   primeira = -1.0;   // s ate a primeira leitura
+    double   somaErroSpo2 = 0.0;
+    unsigned leiturasSpo2 = 0;
+    double   ns = 0.0;          // por amostra crua
+    double   ciclos = 0.0;
+    size_t   memoria = 0;
+};
+
+template <class V>
+static Resultado roda(const Sinal& s, double spo2Alvo) {
+    const size_t n = s.ir.size();
+    std::vector<uint32_t> indices;
+    std::vector<double>   bpms, spo2s;
+    indices.reserve(n / 100);
+    bpms.reserve(n / 100);
+    spo2s.reserve(n / 100);
+
+    // Passagem cronometrada: so o algoritmo e o registro das leituras
+    V* v = new V();
+    const double   t0 = agoraS();
+    const uint64_t c0 = ciclos();
+    for (size_t i = 0; i < n; i++) {
+        double bpm, spo2;
+        if (v->push(s.red[i], s.ir[i], &bpm, &spo2)) {
+            indices.push_back((uint32_t)i);
+            bpms.push_back(bpm);
+            spo2s.push_back(spo2);
+        }
+    }
+    const uint64_t c1 = ciclos();
+    const double   t1 = agoraS();
+
+    Resultado r;
+    r.ns      = (t1 - t0) * 1e9 / n;
+    r.ciclos  = (double)(c1 - c0) / n;
+    r.memoria = v->memoria();
+    delete v;
+
+    for (size_t k = 0; k < indices.size(); k++) {
+        const double t = indices[k] / GeradorPPG::FS;
+        const double verdade = s.verdade->bpmVerdadeiro(t);
+        if (verdade <= 0.0) continue;
+        const double erro = fabs(bpms[k] - verdade);
+        if (r.primeira < 0.0) r.primeira = t;
+        r.leituras++;
+        r.somaErro += erro;
+        if (erro <= 5.0) r.dentro5++;
+        if (spo2s[k] > 0.0) {
+            r.somaErroSpo2 += fabs(spo2s[k] - spo2Alvo);
+            r.leiturasSpo2++;
+        }
+    }
+    return r;
+}
+
+static void imprime(const char* variante, const Resultado& r) {
+    printf("  %-11s", variante);
+    if (r.leituras == 0) {
+        printf(" %8s %7s %8s %6u", "-", "-", "-", 0u);
+    } else {
+        printf(" %8.2f %6.1f%% %8.2f %6u", r.somaErro / r.leituras,
+               100.0 * r.dentro5 / r.leituras, r.primeira, r.leituras);
+    }
+    if (r.leiturasSpo2) {
+        printf(" %7.2f", r.somaErroSpo2 / r.leiturasSpo2);
+    } else {
+        printf(" %7s", "-");
+    }
+    printf(" %8.1f %9.0f %7zu\n", r.ns, r.ciclos, r.memoria);
+}
+
+// Custo por chamada das funcoes auxiliares, sobre um sinal real de tendencias
+static void microBenchmarks(const Sinal& s) {
+    std::vector<uint32_t> medias;
+    for (size_t i = 0; i + DECIMACAO <= s.ir.size(); i += DECIMACAO) {
+        uint32_t soma = 0;
+        for (int k = 0; k < DECIMACAO; k++) soma += s.ir[i + k];
+        medias.push_back(soma / DECIMACAO);
+    }
+
+    volatile uint32_t sorvedouro = 0;
+    const int repeticoes = 50;
+
+    double   t0 = agoraS();
+    uint64_t c0 = ciclos();
+    for (int r = 0; r < repeticoes; r++) {
+        for (size_t i = 0; i + 3 <= medias.size(); i++) {
+            sorvedouro = sorvedouro + calcularTendencia(&medias[i]);
+        }
+    }
+    double chamadas = repeticoes * (double)(medias.size() - 2);
+    printf("  calcularTendencia          %8.1f ns %9.0f ciclos por chamada\n",
+           (agoraS() - t0) * 1e9 / chamadas, (ciclos() - c0) / chamadas);
+
+    // Mediana, DC e passa-faixa do fluxo incremental (Oximetro), por amostra
+    CadeiaPulso cadeia;
+    t0 = agoraS();
+    c0 = ciclos();
+    for (int r = 0; r < repeticoes; r++) {
+        cadeia.reset();
+        for (size_t i = 0; i < medias.size(); i++) {
+            int32_t pulso;
+            if (cadeia.push((int32_t)medias[i], &pulso)) {
+                sorvedouro = sorvedouro + (uint32_t)pulso;
+            }
+        }
+    }
+    chamadas = repeticoes * (double)medias.size();
+    printf("  CadeiaPulso (filtros.h)    %8.1f ns %9.0f ciclos por chamada\n",
+           (agoraS() - t0) * 1e9 / chamadas, (ciclos() - c0) / chamadas);
+
+    t0 = agoraS();
+    c0 = ciclos();
+    chamadas = 0;
+    for (int r = 0; r < repeticoes; r++) {
+        for (size_t i = 0; i + MAXVALUES <= medias.size(); i += MAXVALUES) {
+            sorvedouro = sorvedouro + mediaMaioresVariacoes(&medias[i], MAXVALUES, MAXVARDET);
+            chamadas++;
+        }
+    }
+    printf("  mediaMaioresVariacoes(%d) %8.1f ns %9.0f ciclos por chamada\n", MAXVALUES,
+           (agoraS() - t0) * 1e9 / chamadas, (ciclos() - c0) / chamadas);
+}
+
+int main(int argc, char** argv) {
+    const double   duracao = (argc > 1) ? atof(argv[1]) : 120.0;
+    const uint32_t semente = (argc > 2) ? (uint32_t)atol(argv[2]) : 1;
+
+    Cenario cenarios[] = {
+        {"repouso 72 bpm",      {}},
+        {"bradicardia 48 bpm",  {}},
+        {"taquicardia 150 bpm", {}},
+        {"HRV alta (80 ms)",    {}},
+        {"deriva respiratoria", {}},
+        {"movimento 6/min",     {}},
+        {"ruido alto",          {}},
+        {"baixa perfusao 0.3%", {}},
+    };
+    cenarios[1].p.bpm          = 48.0;
+    cenarios[2].p.bpm          = 150.0;
+    cenarios[3].p.hrvMs        = 80.0;
+    cenarios[4].p.derivaAmp    = 0.005;
+    cenarios[5].p.movimentoMin = 6.0;
+    cenarios[6].p.ruido        = 150.0;
+    cenarios[7].p.perfusao     = 0.003;
+
+    printf("%.0f s por cenario, 1000 sps, semente %u\n", duracao, semente);
+    printf("  %-11s %8s %7s %8s %6s %7s %8s %9s %7s\n", "variante", "MAE bpm", "+-5bpm",
+           "1a (s)", "leit.", "MAE SpO2", "ns/amos", "cic/amos", "RAM (B)");
+
+    Sinal ultimo;
+    for (Cenario& c : cenarios) {
+        c.p.semente = semente;
+        GeradorPPG* gerador = new GeradorPPG(c.p);
+        Sinal s;
+        const size_t n = (size_t)(duracao * GeradorPPG::FS);
+        s.red.resize(n);
+        s.ir.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            gerador->amostra(&s.red[i], &s.ir[i]);
+        }
+        s.verdade = gerador;
+
+        printf("%s\n", c.nome);
+#if CALCMASTER_REFERENCIA_FLOAT
+        imprime(VarianteLote<true>::nome(), roda<VarianteLote<true> >(s, c.p.spo2));
+#endif
+        imprime(VarianteLote<false>::nome(), roda<VarianteLote<false> >(s, c.p.spo2));
+        imprime(VarianteStreaming::nome(), roda<VarianteStreaming>(s, c.p.spo2));
+
+        if (ultimo.verdade) delete ultimo.verdade;
+        ultimo = s;
+    }
+
+    printf("funcoes auxiliares\n");
+    microBenchmarks(ultimo);
+    delete ultimo.verdade;
+    return 0;
+}
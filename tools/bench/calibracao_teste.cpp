@@ -0,0 +1,158 @@
+//!
+//! \file           calibracao_teste.cpp
+//! \brief          Teste no PC da tabela de calibracao do SpO2 por temperatura
+//! \author         Paulo Donizete Antunes Junior
+//! \date           2025-08-28
+//! \version        1.0
+//! \details        Confere CalculadoraSpO2::temperatura em toda a faixa do sensor
+//!                 de temperatura do MAX30102 (-128 a +127.9375 C, em 1/16 C):
+//!
+//!                 - tabela padrao (SPO2_CALIB_TEMPERATURA = 0): A = 110.00 e
+//!                   B = 25.00 em qualquer temperatura, e o SpO2 de um mesmo
+//!                   batimento nao muda com ela;
+//!                 - tabela inclinada (SPO2_CALIB_TEMPERATURA = 1): os pontos da
+//!                   tabela exatos, o meio de cada passo na media dos vizinhos,
+//!                   abaixo de 15 C o primeiro ponto e acima de 50 C o ultimo,
+//!                   sem saltos nem inversoes entre dois valores de 1/16 C.
+//!
+//!                 Sai com 1 se alguma conferencia falhar.
+//!
+//!                 Compilacao:  g++ -O2 -o calibracao_teste tools/bench/calibracao_teste.cpp
+//!                                  lib/MAX30102/calcMaster_.cpp
+//!                              (e de novo com -DSPO2_CALIB_TEMPERATURA=1)
+//!                 Uso:         ./calibracao_teste
+//!
+
+#include "../../lib/MAX30102/calcMaster.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TEMP_MIN_Q4     (-128 * 16)     // faixa do registrador DIE_TINT/DIE_TFRAC
+#define TEMP_MAX_Q4     (127 * 16 + 15)
+
+// O que calcMaster.cpp tem de entregar em cada ponto (A, B x 100)
+static const uint16_t ESPERADO[SPO2_CALIB_PONTOS][2] = {
+#if SPO2_CALIB_TEMPERATURA
+    { 10940, 2380 }, { 10970, 2440 }, { 11000, 2500 }, { 11030, 2560 },
+    { 11060, 2620 }, { 11090, 2680 }, { 11120, 2740 }, { 11150, 2800 },
+#else
+    { 11000, 2500 }, { 11000, 2500 }, { 11000, 2500 }, { 11000, 2500 },
+    { 11000, 2500 }, { 11000, 2500 }, { 11000, 2500 }, { 11000, 2500 },
+#endif
+};
+
+static unsigned falhas = 0;
+
+static void confere(bool ok, const char* descricao) {
+    printf("  %-4s %s\n", ok ? "ok" : "FALHA", descricao);
+    if (!ok) falhas++;
+}
+
+static bool coeficientes(int16_t tempQ4, uint16_t a, uint16_t b) {
+    CalculadoraSpO2 spo2;
+    spo2.temperatura(tempQ4);
+    return spo2.coefAx100() == a && spo2.coefBx100() == b;
+}
+
+static void testaPontos(void) {
+    printf("Pontos da tabela\n");
+    bool ok = true;
+    for (int i = 0; i < SPO2_CALIB_PONTOS; i++) {
+        const int16_t t = (SPO2_CALIB_TEMP_MIN_C + i * SPO2_CALIB_PASSO_C) * 16;
+        ok = ok && coeficientes(t, ESPERADO[i][0], ESPERADO[i][1]);
+    }
+    confere(ok, "15 a 50 C: A e B da tabela");
+
+    ok = true;
+    for (int i = 0; i + 1 < SPO2_CALIB_PONTOS; i++) {
+        const int16_t t = (SPO2_CALIB_TEMP_MIN_C * 2 + (2 * i + 1) * SPO2_CALIB_PASSO_C) * 8;
+        ok = ok && coeficientes(t, (ESPERADO[i][0] + ESPERADO[i + 1][0]) / 2,
+                                   (ESPERADO[i][1] + ESPERADO[i + 1][1]) / 2);
+    }
+    confere(ok, "meio de cada passo: media dos dois vizinhos");
+
+    CalculadoraSpO2 spo2;
+    const int padrao = (SPO2_CALIB_TEMP_PADRAO_C - SPO2_CALIB_TEMP_MIN_C) / SPO2_CALIB_PASSO_C;
+    confere(spo2.coefAx100() == ESPERADO[padrao][0] && spo2.coefBx100() == ESPERADO[padrao][1],
+            "sem leitura de temperatura: ponto de SPO2_CALIB_TEMP_PADRAO_C");
+}
+
+static void testaLimites(void) {
+    printf("Limites\n");
+    const uint16_t* primeiro = ESPERADO[0];
+    const uint16_t* ultimo   = ESPERADO[SPO2_CALIB_PONTOS - 1];
+    const int16_t   fimQ4    = (SPO2_CALIB_TEMP_MIN_C + (SPO2_CALIB_PONTOS - 1) * SPO2_CALIB_PASSO_C) * 16;
+
+    bool ok = true;
+    for (int t = TEMP_MIN_Q4; t <= SPO2_CALIB_TEMP_MIN_C * 16; t++) {
+        ok = ok && coeficientes((int16_t)t, primeiro[0], primeiro[1]);
+    }
+    confere(ok, "-128 a 15 C: primeiro ponto");
+
+    ok = true;
+    for (int t = fimQ4; t <= TEMP_MAX_Q4; t++) {
+        ok = ok && coeficientes((int16_t)t, ultimo[0], ultimo[1]);
+    }
+    confere(ok, "50 a 127.94 C: ultimo ponto");
+
+    // Entre dois valores de 1/16 C o coeficiente anda no maximo um degrau da
+    // interpolacao e sempre no sentido da tabela
+    CalculadoraSpO2 spo2;
+    spo2.temperatura(TEMP_MIN_Q4);
+    int aAnterior = spo2.coefAx100();
+    int bAnterior = spo2.coefBx100();
+    int maiorPassoA = 0, maiorPassoB = 0;
+    bool monotono = true;
+    for (int t = TEMP_MIN_Q4 + 1; t <= TEMP_MAX_Q4; t++) {
+        spo2.temperatura((int16_t)t);
+        const int da = spo2.coefAx100() - aAnterior;
+        const int db = spo2.coefBx100() - bAnterior;
+        monotono = monotono && da * (ultimo[0] - primeiro[0]) >= 0 && db * (ultimo[1] - primeiro[1]) >= 0;
+        if (abs(da) > maiorPassoA) maiorPassoA = abs(da);
+        if (abs(db) > maiorPassoB) maiorPassoB = abs(db);
+        aAnterior = spo2.coefAx100();
+        bAnterior = spo2.coefBx100();
+    }
+    confere(monotono, "A e B nao invertem o sentido da tabela");
+    char descricao[80];
+    snprintf(descricao, sizeof(descricao), "maior passo em 1/16 C: A %d, B %d (<= 1)", maiorPassoA, maiorPassoB);
+    confere(maiorPassoA <= 1 && maiorPassoB <= 1, descricao);
+}
+
+// SpO2 x 100 de um batimento com R ~ 1 (perto de 85%, onde a inclinacao pesa)
+static uint16_t batimentoEm(int16_t tempQ4) {
+    CalculadoraSpO2 spo2;
+    spo2.temperatura(tempQ4);
+    spo2.push(100000, 100000);
+    spo2.batimento();           // a primeira janela depois do reset e descartada
+    for (int n = 0; n < 50; n++) {
+        const uint32_t ac = (n & 1) ? 1000 : 0;
+        spo2.push(100000 + ac, 100000 + ac);
+    }
+    return spo2.batimento();
+}
+
+static void testaSpO2(void) {
+    printf("SpO2 de um batimento\n");
+    const uint16_t frio   = batimentoEm(0);
+    const uint16_t padrao = batimentoEm(SPO2_CALIB_TEMP_PADRAO_C * 16);
+    const uint16_t quente = batimentoEm(60 * 16);
+    char descricao[80];
+    snprintf(descricao, sizeof(descricao), "0 C %u, 25 C %u, 60 C %u", frio, padrao, quente);
+    confere(padrao > 0, descricao);
+#if SPO2_CALIB_TEMPERATURA
+    confere(frio != padrao && quente != padrao, "tabela inclinada: a temperatura muda o SpO2");
+#else
+    confere(frio == padrao && quente == padrao, "tabela padrao: a temperatura nao muda o SpO2");
+#endif
+}
+
+int main(void) {
+    printf("SPO2_CALIB_TEMPERATURA = %d\n", SPO2_CALIB_TEMPERATURA);
+    testaPontos();
+    testaLimites();
+    testaSpO2();
+    printf("%u falha(s)\n", falhas);
+    return falhas ? 1 : 0;
+}
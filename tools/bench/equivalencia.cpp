@@ -0,0 +1,195 @@
+//!
+//! \file           equivalencia.cpp
+//! \brief          Confere detectarValesEBPMx100 contra a referencia em float (PC)
+//! \author         Paulo Donizete Antunes Junior
+//! \date           2025-08-16
+//! \version        1.0
+//! \details        Passa os mesmos traces pelas duas versoes do calculo em lote e
+//!                 compara janela a janela (janela deslizante de MAXVALUES
+//!                 tendencias, passo de uma tendencia):
+//!
+//!                 - os vales encontrados tem de ser os mesmos;
+//!                 - |BPM x100 - 100 * BPM float| <= TOLERANCIA_X100 (1 LSB: o
+//!                   inteiro trunca, o float nao).
+//!
+//!                 Os traces sao os cenarios de ppg_sintetico.h (os de bench.cpp mais
+//!                 uma varredura de 35 a 220 BPM) e, se for dada, uma captura
+//!                 "red,ir" ou "amostra,red,ir" (tools/telemetry_decoder).
+//!                 Sai com 1 se alguma janela divergir.
+//!
+//!                 Compilacao:  g++ -O2 -DCALCMASTER_REFERENCIA_FLOAT=1 -o equivalencia
+//!                                  tools/bench/equivalencia.cpp lib/MAX30102/calcMaster_.cpp
+//!                 Uso:         ./equivalencia [segundos por cenario] [semente] [captura.csv [sps]]
+//!
+
+#include "ppg_sintetico.h"
+#include "../../lib/MAX30102/calcMaster.h"
+
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+#if !CALCMASTER_REFERENCIA_FLOAT
+#error "compilar com -DCALCMASTER_REFERENCIA_FLOAT=1"
+#endif
+
+#define TOLERANCIA_X100 1.0     // LSB de BPM x 100
+
+struct Comparacao {
+    unsigned janelas = 0;
+    unsigned comBpm = 0;        // janelas com BPM nas duas versoes
+    unsigned falhas = 0;
+    double   maiorDif = 0.0;    // LSB de BPM x 100
+    double   somaDif = 0.0;
+};
+
+// Media de decimacao amostras cruas e tendencia de 3, como no fluxo original da main
+static std::vector<uint32_t> tendencias(const std::vector<uint32_t>& ir, int decimacao) {
+    std::vector<uint32_t> saida;
+    uint32_t janela[3] = {0, 0, 0};
+    unsigned medias = 0;
+    for (size_t i = 0; i + decimacao <= ir.size(); i += decimacao) {
+        uint32_t soma = 0;
+        for (int k = 0; k < decimacao; k++) soma += ir[i + k];
+        janela[0] = janela[1];
+        janela[1] = janela[2];
+        janela[2] = soma / decimacao;
+        if (++medias >= 3) {
+            saida.push_back(calcularTendencia(janela));
+        }
+    }
+    return saida;
+}
+
+static Comparacao compara(const char* nome, const std::vector<uint32_t>& dados) {
+    Comparacao c;
+    uint16_t valesInt[MAXVALUES];
+    uint16_t valesFloat[MAXVALUES];
+
+    for (size_t inicio = 0; inicio + MAXVALUES <= dados.size(); inicio++) {
+        const uint32_t* janela = &dados[inicio];
+        for (int k = 0; k < MAXVALUES; k++) {
+            valesInt[k] = valesFloat[k] = 0xFFFF;
+        }
+        const uint16_t bpmX100 = detectarValesEBPMx100(janela, MAXVALUES, valesInt, MAXVARDET);
+        const float    bpm     = detectarValesEBPM(janela, MAXVALUES, valesFloat, MAXVARDET);
+        c.janelas++;
+
+        bool ok = true;
+        for (int k = 0; k < MAXVALUES && (valesInt[k] != 0xFFFF || valesFloat[k] != 0xFFFF); k++) {
+            if (valesInt[k] != valesFloat[k]) {
+                ok = false;
+                break;
+            }
+        }
+        const double dif = fabs(bpmX100 - 100.0 * bpm);
+        if (dif > TOLERANCIA_X100) {
+            ok = false;
+        }
+        if (bpmX100 != 0 && bpm > 0.0f) {
+            c.comBpm++;
+            c.somaDif += dif;
+            if (dif > c.maiorDif) c.maiorDif = dif;
+        }
+        if (!ok) {
+            if (c.falhas < 5) {
+                printf("  FALHA %s janela %zu: x100 %u  float %.4f\n", nome, inicio, bpmX100, bpm);
+            }
+            c.falhas++;
+        }
+    }
+    return c;
+}
+
+static void imprime(const char* nome, const Comparacao& c) {
+    printf("  %-22s %7u %7u %9.3f %9.3f %6u\n", nome, c.janelas, c.comBpm,
+           c.comBpm ? c.somaDif / c.comBpm : 0.0, c.maiorDif, c.falhas);
+}
+
+// Captura "red,ir" ou "amostra,red,ir"; devolve false se nao abrir
+static bool leCaptura(const char* arquivo, std::vector<uint32_t>* ir) {
+    FILE* f = fopen(arquivo, "r");
+    if (f == NULL) return false;
+    char linha[96];
+    while (fgets(linha, sizeof(linha), f) != NULL) {
+        if (!isdigit((unsigned char)linha[0])) continue;
+        unsigned long v[3];
+        const int campos = sscanf(linha, "%lu,%lu,%lu", &v[0], &v[1], &v[2]);
+        if (campos >= 2) ir->push_back((uint32_t)v[campos - 1]);
+    }
+    fclose(f);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    const double   duracao = (argc > 1) ? atof(argv[1]) : 120.0;
+    const uint32_t semente = (argc > 2) ? (uint32_t)atol(argv[2]) : 1;
+    const char*    captura = (argc > 3) ? argv[3] : NULL;
+    const double   sps     = (argc > 4) ? atof(argv[4]) : SAMPLE_RATE;
+
+    struct Cenario {
+        char          nome[32];
+        ParametrosPPG p;
+    };
+    std::vector<Cenario> cenarios(8);
+    snprintf(cenarios[0].nome, sizeof(cenarios[0].nome), "repouso 72 bpm");
+    snprintf(cenarios[1].nome, sizeof(cenarios[1].nome), "bradicardia 48 bpm");
+    snprintf(cenarios[2].nome, sizeof(cenarios[2].nome), "taquicardia 150 bpm");
+    snprintf(cenarios[3].nome, sizeof(cenarios[3].nome), "HRV alta (80 ms)");
+    snprintf(cenarios[4].nome, sizeof(cenarios[4].nome), "deriva respiratoria");
+    snprintf(cenarios[5].nome, sizeof(cenarios[5].nome), "movimento 6/min");
+    snprintf(cenarios[6].nome, sizeof(cenarios[6].nome), "ruido alto");
+    snprintf(cenarios[7].nome, sizeof(cenarios[7].nome), "baixa perfusao 0.3%%");
+    cenarios[1].p.bpm          = 48.0;
+    cenarios[2].p.bpm          = 150.0;
+    cenarios[3].p.hrvMs        = 80.0;
+    cenarios[4].p.derivaAmp    = 0.005;
+    cenarios[5].p.movimentoMin = 6.0;
+    cenarios[6].p.ruido        = 150.0;
+    cenarios[7].p.perfusao     = 0.003;
+    // Varredura de frequencia: cobre a conversao intervalo -> BPM em toda a faixa
+    for (int bpm = 35; bpm <= 220; bpm += 15) {
+        Cenario c;
+        snprintf(c.nome, sizeof(c.nome), "varredura %d bpm", bpm);
+        c.p.bpm   = bpm;
+        c.p.hrvMs = 0.0;
+        cenarios.push_back(c);
+    }
+
+    printf("%.0f s por cenario, semente %u, tolerancia %.0f LSB de BPM x100\n",
+           duracao, semente, TOLERANCIA_X100);
+    printf("  %-22s %7s %7s %9s %9s %6s\n", "trace", "janelas", "c/ BPM", "dif media", "dif max", "falhas");
+
+    // O gerador simula o sensor antes da media no chip (GeradorPPG::FS)
+    const int decimacao = (int)(GeradorPPG::FS * 1000.0 / SAMPLE_RATE_MHZ + 0.5);
+    unsigned falhas = 0;
+    for (Cenario& c : cenarios) {
+        c.p.semente = semente;
+        GeradorPPG gerador(c.p);
+        const size_t n = (size_t)(duracao * GeradorPPG::FS);
+        std::vector<uint32_t> red(n), ir(n);
+        for (size_t i = 0; i < n; i++) {
+            gerador.amostra(&red[i], &ir[i]);
+        }
+        const Comparacao r = compara(c.nome, tendencias(ir, decimacao));
+        imprime(c.nome, r);
+        falhas += r.falhas;
+    }
+
+    if (captura != NULL) {
+        std::vector<uint32_t> ir;
+        const long decimacaoCaptura = (long)(sps / SAMPLE_RATE + 0.5);
+        if (decimacaoCaptura < 1 || !leCaptura(captura, &ir)) {
+            perror(captura);
+            return 1;
+        }
+        const Comparacao r = compara(captura, tendencias(ir, (int)decimacaoCaptura));
+        imprime(captura, r);
+        falhas += r.falhas;
+    }
+
+    printf("%s\n", falhas ? "DIVERGENTE" : "equivalentes");
+    return falhas ? 1 : 0;
+}
@@ -0,0 +1,218 @@
+//!
+//! \file           filtros_teste.cpp
+//! \brief          Teste no PC dos estagios de filtros.h
+//! \author         Paulo Donizete Antunes Junior
+//! \date           2025-08-26
+//! \version        1.0
+//! \details        Confere o que filtros.h promete:
+//!
+//!                 - PassaFaixaPulso: -3 dB em 0.3 e 4 Hz, -0.6 dB em 1.1 Hz,
+//!                   -1.4 dB em 0.5 Hz, -7 dB em 8 Hz, DC e fs / 2 rejeitados;
+//!                 - FiltroDc<6>: -3 dB em 0.155 Hz, DC rejeitado, sem degrau na
+//!                   primeira amostra;
+//!                 - Biquad: saturacao em +-LIMITE (com o resto zerado), sem vies de
+//!                   truncamento e sem ciclo-limite depois de um impulso;
+//!                 - MediaDecimada e Mediana3: medias, janela enchendo e picos.
+//!
+//!                 O ganho e a razao RMS saida / entrada de uma senoide em regime,
+//!                 em 62.5 Hz (SAMPLE_RATE). Sai com 1 se alguma conferencia falhar.
+//!
+//!                 Compilacao:  g++ -O2 -o filtros_teste tools/bench/filtros_teste.cpp
+//!                 Uso:         ./filtros_teste
+//!
+
+#include "../../lib/MAX30102/filtros.h"
+#include "../../lib/MAX30102/calcMaster.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static unsigned falhas = 0;
+
+static void confere(bool ok, const char* descricao) {
+    printf("  %-4s %s\n", ok ? "ok" : "FALHA", descricao);
+    if (!ok) falhas++;
+}
+
+// Ganho em dB de um estagio para uma senoide de hz, com amplitude e nivel DC dados
+template <class F>
+static double ganhoDb(double hz, double amplitude, double dc = 0.0) {
+    const double fs = SAMPLE_RATE_MHZ / 1000.0;
+    // Regime: 60 s ou 10 periodos; medida: 40 periodos inteiros
+    const long regime = (long)(fs * fmax(60.0, 10.0 / hz));
+    const long medida = (long)(fs * 40.0 / hz + 0.5);
+    F filtro;
+    double somaEntrada = 0.0, somaSaida = 0.0;
+    for (long n = 0; n < regime + medida; n++) {
+        const double x = amplitude * sin(2.0 * M_PI * hz * n / fs);
+        int32_t y;
+        filtro.push((int32_t)lround(dc + x), &y);
+        if (n >= regime) {
+            somaEntrada += x * x;
+            somaSaida   += (double)y * y;
+        }
+    }
+    return 10.0 * log10(somaSaida / somaEntrada);
+}
+
+static bool perto(double valor, double alvo, double tolerancia) {
+    return fabs(valor - alvo) <= tolerancia;
+}
+
+static void testaPassaFaixa(void) {
+    printf("PassaFaixaPulso\n");
+    const struct {
+        double hz, db;
+    } pontos[] = {
+        {0.3, -3.0}, {0.5, -1.4}, {1.1, -0.6}, {4.0, -3.0}, {8.0, -7.0},
+    };
+    for (const auto& p : pontos) {
+        const double g = ganhoDb<PassaFaixaPulso>(p.hz, 100000.0);
+        char descricao[80];
+        snprintf(descricao, sizeof(descricao), "%4.1f Hz: %6.2f dB (esperado %.1f +-0.3)", p.hz, g, p.db);
+        confere(perto(g, p.db, 0.3), descricao);
+    }
+
+    // fs / 2: +-A alternado; o zero do numerador em z = -1 derruba o ganho
+    PassaFaixaPulso pf;
+    int32_t y, pico = 0;
+    for (int n = 0; n < 2000; n++) {
+        pf.push((n & 1) ? -100000 : 100000, &y);
+        if (n >= 1000 && abs(y) > pico) pico = abs(y);
+    }
+    char descricao[80];
+    snprintf(descricao, sizeof(descricao), "fs / 2: pico %d de 100000 (<= -60 dB)", pico);
+    confere(pico <= 100, descricao);
+
+    // DC: o zero em z = 1 leva a saida exatamente a zero
+    pf.reset();
+    bool zerou = false;
+    for (int n = 0; n < 2000; n++) {
+        pf.push(100000, &y);
+        zerou = (y == 0);
+    }
+    confere(zerou, "DC de 100000: saida 0 em regime");
+}
+
+static void testaFiltroDc(void) {
+    printf("FiltroDc<6>\n");
+    // Nivel DC de 18 bits somado: so a componente alternada tem de sobrar
+    const double g = ganhoDb<FiltroDc<6> >(0.155, 1000.0, 100000.0);
+    char descricao[80];
+    snprintf(descricao, sizeof(descricao), "0.155 Hz: %6.2f dB (esperado -3.0 +-0.5)", g);
+    confere(perto(g, -3.0, 0.5), descricao);
+    const double g1 = ganhoDb<FiltroDc<6> >(1.1, 1000.0, 100000.0);
+    snprintf(descricao, sizeof(descricao), " 1.1 Hz: %6.2f dB (esperado > -0.2)", g1);
+    confere(g1 > -0.2, descricao);
+
+    FiltroDc<6> dc;
+    int32_t y;
+    dc.push(200000, &y);
+    confere(y == 0, "primeira amostra: saida 0 (o DC comeca nela)");
+    bool dentro = true;
+    for (int n = 0; n < 2000; n++) {
+        dc.push(150000, &y);
+        if (n >= 1500) dentro = dentro && abs(y) <= 1;
+    }
+    confere(dentro, "degrau de DC: saida em +-1 em regime");
+}
+
+// Passa-baixas de um polo com ganho DC 1 (41 / (4096 - 4055)) e um de ganho 2
+typedef Biquad<41, 0, 0, -4055, 0, 12> PassaBaixasLento;
+typedef Biquad<8192, 0, 0, 0, 0, 12>   Dobra;
+
+static void testaBiquad(void) {
+    printf("Biquad\n");
+    int32_t y;
+
+    Dobra dobra;
+    dobra.push(1 << 30, &y);
+    confere(y == Dobra::LIMITE, "entrada acima de LIMITE: saida em +LIMITE");
+    dobra.push(-(1 << 30), &y);
+    confere(y == -Dobra::LIMITE, "entrada abaixo de -LIMITE: saida em -LIMITE");
+    dobra.reset();
+    dobra.push(Dobra::LIMITE, &y);
+    confere(y == Dobra::LIMITE, "saida acima de LIMITE: saturada em +LIMITE");
+    dobra.push(0, &y);
+    confere(y == 0, "depois de saturar: o resto zerado nao vaza na amostra seguinte");
+
+    // Sem realimentacao do erro, y para onde (41 x + 4055 y) >> 12 == y, abaixo de x
+    PassaBaixasLento lento;
+    for (int n = 0; n < 5000; n++) {
+        lento.push(1000, &y);
+    }
+    char descricao[80];
+    snprintf(descricao, sizeof(descricao), "degrau de 1000 com ganho 1: regime %d (sem vies)", y);
+    confere(y == 1000, descricao);
+    for (int n = 0; n < 5000; n++) {
+        lento.push(0, &y);
+    }
+    confere(y == 0, "volta a 0: sem residuo de truncamento");
+
+    // Impulso no passa-faixa: a saida tem de morrer em zero e ficar la
+    PassaFaixaPulso pf;
+    pf.push(100000, &y);
+    int ultimaNaoNula = 0;
+    for (int n = 1; n < 5000; n++) {
+        pf.push(0, &y);
+        if (y != 0) ultimaNaoNula = n;
+    }
+    snprintf(descricao, sizeof(descricao), "impulso: ultima saida nao nula na amostra %d (< 1000)", ultimaNaoNula);
+    confere(ultimaNaoNula < 1000, descricao);
+}
+
+static void testaMediaDecimada(void) {
+    printf("MediaDecimada\n");
+    MediaDecimada media(4);
+    int32_t y = -1;
+    bool saidas[8];
+    int32_t valores[8];
+    int k = 0;
+    for (int n = 0; n < 8; n++) {
+        saidas[n] = media.push(n + 1, &y);
+        if (saidas[n]) valores[k++] = y;
+    }
+    confere(!saidas[0] && !saidas[1] && !saidas[2] && saidas[3] &&
+            !saidas[4] && !saidas[5] && !saidas[6] && saidas[7], "fator 4: uma saida a cada 4 entradas");
+    confere(k == 2 && valores[0] == 2 && valores[1] == 6, "medias de 1..4 e 5..8: 2 e 6 (divisao inteira)");
+
+    MediaDecimada um(0);
+    confere(um.fator() == 1 && um.push(123, &y) && y == 123, "fator 0 vira 1: passa direto");
+
+    media.push(100, &y);
+    media.reset();
+    bool saiu = false;
+    for (int n = 0; n < 4; n++) saiu = media.push(8, &y);
+    confere(saiu && y == 8, "reset descarta a soma parcial");
+}
+
+static void testaMediana3(void) {
+    printf("Mediana3\n");
+    Mediana3 mediana;
+    int32_t y = -1;
+    const bool primeira = mediana.push(10, &y);
+    const bool segunda  = mediana.push(10, &y);
+    confere(!primeira && !segunda, "duas primeiras amostras so enchem a janela");
+
+    const int32_t entrada[]  = {1000, 10, 10, -1000, 10, 10, 50, 50, 50};
+    const int32_t esperado[] = {10, 10, 10, 10, 10, 10, 10, 50, 50};
+    bool ok = true;
+    for (unsigned n = 0; n < sizeof(entrada) / sizeof(entrada[0]); n++) {
+        ok = mediana.push(entrada[n], &y) && ok && y == esperado[n];
+    }
+    confere(ok, "picos de uma amostra removidos, degrau passa com uma amostra de atraso");
+
+    mediana.reset();
+    confere(!mediana.push(5, &y), "reset volta a encher a janela");
+}
+
+int main(void) {
+    testaPassaFaixa();
+    testaFiltroDc();
+    testaBiquad();
+    testaMediaDecimada();
+    testaMediana3();
+    printf("%u falha(s)\n", falhas);
+    return falhas ? 1 : 0;
+}
@@ -0,0 +1,140 @@
+//!
+//! \file           ppg_sintetico.h
+//! \brief          Gerador parametrizado de PPG sintetico (RED/IR, 1000 sps)
+//! \author         Paulo Donizete Antunes Junior
+//! \date           2025-08-16
+//! \version        1.0
+//! \details        Produz amostras no formato da FIFO do MAX30102 (18 bits) a
+//!                 partir de: frequencia cardiaca, variabilidade (HRV), deriva de
+//!                 linha de base, artefatos de movimento, ruido e indice de
+//!                 perfusao. Guarda o instante de cada batimento para servir de
+//!                 verdade nas metricas de tools/bench/bench.cpp. Deterministico
+//!                 para uma mesma semente.
+//!
+
+#ifndef PPG_SINTETICO_H
+#define PPG_SINTETICO_H
+
+#include <math.h>
+#include <stdint.h>
+#include <vector>
+
+struct ParametrosPPG {
+    double bpm          = 72.0;     // frequencia media
+    double hrvMs        = 30.0;     // desvio padrao dos intervalos RR (ms)
+    double perfusao     = 0.02;     // indice de perfusao: AC/DC do IR
+    double spo2         = 97.0;     // SpO2 alvo (%), pela curva SpO2 = 110 - 25 R
+    double dicrotico    = 0.25;     // altura do pico dicrotico relativa a sistole
+    double derivaAmp    = 0.0;      // deriva respiratoria (fracao do DC)
+    double derivaHz     = 0.25;
+    double movimentoMin = 0.0;      // artefatos de movimento por minuto
+    double movimentoAmp = 0.01;     // amplitude do artefato (fracao do DC)
+    double ruido        = 20.0;     // desvio padrao do ruido branco (contagens)
+    double dcIr         = 100000.0; // nivel DC (contagens de 18 bits)
+    double dcRed        = 80000.0;
+    uint32_t semente    = 1;
+};
+
+class GeradorPPG {
+public:
+    static constexpr double FS = 1000.0;
+
+    explicit GeradorPPG(const ParametrosPPG& p) : _p(p), _estado(p.semente ? p.semente : 1) {
+        _rr = proximoRR();
+        _proximoMovimento = sorteiaMovimento(0.0);
+    }
+
+    // Proxima amostra crua (o sinal nao tem fim)
+    void amostra(uint32_t* red, uint32_t* ir) {
+        const double t = _n++ / FS;
+
+        // Novo batimento quando a fase completa o intervalo RR atual
+        if (t - _inicioBatimento >= _rr) {
+            _inicioBatimento += _rr;
+            _batimentos.push_back(_inicioBatimento);
+            _rr = proximoRR();
+        }
+        const double fase = (t - _inicioBatimento) / _rr;
+        const double pulso = gauss(fase, 0.15, 0.06) + _p.dicrotico * gauss(fase, 0.45, 0.08);
+
+        // Componentes comuns aos dois canais (fracao do DC)
+        double comum = _p.derivaAmp * sin(2.0 * M_PI * _p.derivaHz * t);
+        if (t >= _proximoMovimento) {
+            _movimentoInicio = _proximoMovimento;
+            _movimentoSinal = (aleatorio() < 0.5) ? -1.0 : 1.0;
+            _proximoMovimento = sorteiaMovimento(t);
+        }
+        const double dm = t - _movimentoInicio;
+        if (_movimentoInicio >= 0.0 && dm < 0.3) {
+            comum += _movimentoSinal * _p.movimentoAmp * sin(M_PI * dm / 0.3);
+        }
+
+        const double r = (110.0 - _p.spo2) / 25.0;
+        const double vIr  = _p.dcIr  * (1.0 + comum - _p.perfusao * pulso) + _p.ruido * normal();
+        const double vRed = _p.dcRed * (1.0 + comum - _p.perfusao * r * pulso) + _p.ruido * normal();
+        *ir  = satura(vIr);
+        *red = satura(vRed);
+    }
+
+    // Tempo (s) do inicio de cada batimento ja gerado
+    const std::vector<double>& batimentos() const { return _batimentos; }
+
+    // BPM verdadeiro: media dos ultimos 'n' intervalos completos antes de t
+    double bpmVerdadeiro(double t, int n = 4) const {
+        int fim = (int)_batimentos.size() - 1;
+        while (fim >= 0 && _batimentos[fim] > t) fim--;
+        if (fim < 1) return 0.0;
+        int ini = fim - n;
+        if (ini < 0) ini = 0;
+        return 60.0 * (fim - ini) / (_batimentos[fim] - _batimentos[ini]);
+    }
+
+private:
+    static double gauss(double x, double centro, double largura) {
+        const double d = (x - centro) / largura;
+        return exp(-d * d);
+    }
+
+    static uint32_t satura(double v) {
+        if (v < 0.0) return 0;
+        if (v > 262143.0) return 262143;
+        return (uint32_t)v;
+    }
+
+    // xorshift32 + Box-Muller
+    double aleatorio() {
+        _estado ^= _estado << 13;
+        _estado ^= _estado >> 17;
+        _estado ^= _estado << 5;
+        return (_estado + 0.5) / 4294967296.0;
+    }
+
+    double normal() {
+        return sqrt(-2.0 * log(aleatorio())) * cos(2.0 * M_PI * aleatorio());
+    }
+
+    double proximoRR() {
+        const double media = 60.0 / _p.bpm;
+        double rr = media + _p.hrvMs / 1000.0 * normal();
+        if (rr < 0.7 * media) rr = 0.7 * media;
+        if (rr > 1.3 * media) rr = 1.3 * media;
+        return rr;
+    }
+
+    double sorteiaMovimento(double t) {
+        if (_p.movimentoMin <= 0.0) return 1e30;
+        return t - log(aleatorio()) * 60.0 / _p.movimentoMin;  // processo de Poisson
+    }
+
+    ParametrosPPG       _p;
+    uint32_t            _estado;
+    uint64_t            _n = 0;
+    double              _rr;
+    double              _inicioBatimento = 0.0;
+    double              _proximoMovimento;
+    double              _movimentoInicio = -1.0;
+    double              _movimentoSinal = 1.0;
+    std::vector<double> _batimentos;
+};
+
+#endif // PPG_SINTETICO_H
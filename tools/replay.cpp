@@ -0,0 +1,112 @@
+//!
+//! \file           replay.cpp
+//! \brief          Reproducao (Linux) de capturas RED/IR pela cadeia real do oximetro
+//! \author         Paulo Donizete Antunes Junior
+//! \date           2025-08-14
+//! \version        1.0
+//! \details        Entrega as amostras de uma captura (CSV de tools/telemetry_decoder
+//!                 ou "red,ir") ao mesmo processamento de bloco de src/main.cpp
+//!                 (lib/medicao: presenca, Oximetro, ganho, temperatura e
+//!                 telemetria), atraves do backend Linux de lib/hal. Cada mudanca de
+//!                 BPM/SpO2 sai em stdout como CSV (tempo_ms,bpm,spo2); o resumo e
+//!                 a vazao do processamento vao para stderr.
+//!
+//!                 Compilacao:  g++ -O2 -Ilib/TWI -o replay tools/replay.cpp lib/hal/hal_.cpp
+//!                                  lib/medicao/medicao_.cpp lib/telemetry/telemetry_.cpp
+//!                                  lib/MAX30102/oximetro_.cpp lib/MAX30102/calcMaster_.cpp
+//!                                  lib/MAX30102/presenca_.cpp lib/MAX30102/ganho_.cpp
+//!                 Uso:         ./replay captura.csv > medidas.csv
+//!                              ./replay captura.csv 100 > /dev/null   (repete 100x: benchmark)
+//!                              ./replay captura.csv 1 1000            (captura de 1000 sps)
+//!                              ./replay captura.csv 1 62.5 debug.bin  (modo debug: telemetria
+//!                                                                      em debug.bin)
+//!                 Sem argumento le da entrada padrao. A taxa padrao e a da FIFO do
+//!                 firmware (62.5 sps, media no chip); capturas feitas antes disso
+//!                 sao de 1000 sps e passam pela media em software do Oximetro.
+//!
+
+#include "../lib/hal/hal.h"
+#include "../lib/medicao/medicao.h"
+#include "../lib/telemetry/telemetry.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static double agoraS(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char** argv) {
+    const char* arquivo = (argc > 1) ? argv[1] : NULL;
+    long repeticoes = (argc > 2) ? atol(argv[2]) : 1;
+    double sps = (argc > 3) ? atof(argv[3]) : SAMPLE_RATE;
+    const char* telemetria = (argc > 4) ? argv[4] : NULL;
+    // Fontes acima de SAMPLE_RATE: media em software de decimacao amostras
+    long decimacao = (long)(sps / SAMPLE_RATE + 0.5);
+    if (repeticoes < 1 || (arquivo == NULL && repeticoes > 1) || decimacao < 1 || decimacao > 255) {
+        fprintf(stderr, "uso: %s [captura.csv [repeticoes [sps [telemetria.bin]]]]\n", argv[0]);
+        return 1;
+    }
+    if (!hal_replay_serial(telemetria)) {
+        perror(telemetria);
+        return 1;
+    }
+
+    hal_replay_taxa((uint32_t)(sps * 1000.0 + 0.5));
+    Medicao medicao((uint8_t)decimacao);
+    unsigned long amostras = 0, batimentos = 0, entradas = 0, saidas = 0, lacunas = 0;
+    double processamento = 0.0;
+
+    hal_display_init();
+
+    for (long r = 0; r < repeticoes; r++) {
+        if (!hal_replay_abre(arquivo)) {
+            perror(arquivo ? arquivo : "stdin");
+            return 1;
+        }
+        medicao.reset();
+        hal_display_modo(telemetria != NULL);
+
+        while (!hal_replay_fim()) {
+            uint8_t n;
+            const max30102Sample_t* bloco = hal_sensor_bloco(&n);
+            if (bloco == NULL) {
+                continue;
+            }
+
+            // O mesmo processamento de processaBPM em src/main.cpp
+            double t0 = agoraS();
+            lacunas += (n && hal_sensor_perdidas()) ? 1 : 0;
+            uint8_t eventos = medicao.bloco(bloco, n, telemetria != NULL);
+            if (eventos & MEDICAO_SAIU) {
+                hal_display_medidas(0, 0);
+            }
+            if (eventos & MEDICAO_BATIMENTO) {
+                batimentos++;
+                hal_display_medidas(medicao.bpmX100(), medicao.spo2X100());
+            }
+            entradas += (eventos & MEDICAO_CHEGOU) ? 1 : 0;
+            saidas   += (eventos & MEDICAO_SAIU) ? 1 : 0;
+            processamento += agoraS() - t0;
+            amostras += n;
+        }
+    }
+    telemetriaFlush();
+    hal_replay_serial(NULL);
+
+    fflush(stdout);
+    fprintf(stderr, "amostras: %lu  batimentos: %lu  dedo: %lu entradas, %lu saidas  lacunas: %lu\n",
+            amostras, batimentos, entradas, saidas, lacunas);
+    fprintf(stderr, "ultimo BPM: %u.%02u  SpO2: %u.%02u %%  LED red %u ir %u  faixa %u nA\n",
+            medicao.bpmX100() / 100, medicao.bpmX100() % 100,
+            medicao.spo2X100() / 100, medicao.spo2X100() % 100,
+            medicao.ganho().paRed(), medicao.ganho().paIr(), medicao.ganho().faixaNa());
+    if (processamento > 0.0) {
+        fprintf(stderr, "processamento: %.3f s  (%.2f Mamostras/s, %.0fx tempo real a %g sps)\n",
+                processamento, amostras / processamento / 1e6, amostras / processamento / sps, sps);
+    }
+    return 0;
+}
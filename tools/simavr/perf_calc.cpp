@@ -0,0 +1,52 @@
+//!
+//! \file           perf_calc.cpp
+//! \brief          Firmware de medicao dos detectores em lote de calcMaster
+//! \author         Paulo Donizete Antunes Junior
+//! \date           2025-08-18
+//! \version        1.0
+//! \details        detectarValesEBPM (float) nao entra no firmware normal, entao
+//!                 este programa chama as duas variantes em lote sobre um buffer
+//!                 de MAXVALUES tendencias sinteticas (75 bpm a 62.5 Hz) e dorme
+//!                 com interrupcoes desligadas, o que encerra o simavr.
+//!
+//!                 Compilacao:  avr-g++ -mmcu=atmega328p -Os -DF_CPU=16000000UL -DPERF_ENABLE
+//!                                  -DCALCMASTER_REFERENCIA_FLOAT=1 -Ilib -o perf_calc.elf
+//!                                  tools/simavr/perf_calc.cpp lib/MAX30102/calcMaster_.cpp
+//!                 Uso:         ./perf_harness perf_calc.elf
+//!
+
+#include "../../lib/MAX30102/calcMaster.h"
+
+#include <avr/interrupt.h>
+#include <avr/sleep.h>
+
+#define REPETICOES 8
+
+static uint32_t tendencias[MAXVALUES];
+static uint16_t vales[MAXVALUES];
+volatile float    bpmFloat;
+volatile uint16_t bpmX100;
+
+int main(void)
+{
+    // Pulso de 50 amostras (75 bpm): descida rapida, subida lenta, com ruido de LCG
+    uint16_t lcg = 1;
+    for (uint16_t i = 0; i < MAXVALUES; i++) {
+        uint8_t fase = i % 50;
+        uint32_t pulso = (fase < 8) ? fase * 375UL : 3000UL - (fase - 8) * 3000UL / 42;
+        lcg = lcg * 25173 + 13849;
+        tendencias[i] = 100000UL - pulso + (lcg >> 10);
+    }
+
+    for (uint8_t r = 0; r < REPETICOES; r++) {
+#if CALCMASTER_REFERENCIA_FLOAT
+        bpmFloat = detectarValesEBPM(tendencias, MAXVALUES, vales, MAXVARDET);
+#endif
+        bpmX100  = detectarValesEBPMx100(tendencias, MAXVALUES, vales, MAXVARDET);
+    }
+
+    cli();
+    sleep_enable();
+    sleep_cpu();
+    while (1);
+}
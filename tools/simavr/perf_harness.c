@@ -0,0 +1,568 @@
+//!
+//! \file           perf_harness.c
+//! \brief          Medicao de ciclos do firmware no simavr (sem hardware)
+//! \author         Paulo Donizete Antunes Junior
+//! \date           2025-08-18
+//! \version        1.0
+//! \details        Roda um ELF do ATmega328P (16 MHz) no simavr com:
+//!                   - modelo I2C do MAX30102 (0x57) alimentado por uma captura
+//!                     CSV ("red,ir") na taxa de SPO2_CONFIG, com a media de
+//!                     FIFO_CONFIG, FIFO de 32 amostras, A_FULL, modo de
+//!                     proximidade (PROX_INT), temperatura do die (25 C, ~29 ms)
+//!                     e o pino INT em PD2 (INT0). Capturas de
+//!                     tools/telemetry_decoder ja saem da FIFO com a media: -m
+//!                     entrega uma linha por amostra;
+//!                   - sorvedouro SPI no lugar do ST7735 (so conta bytes);
+//!                   - USART0 capturada (opcionalmente ecoada em stderr).
+//!                 As escritas em GPIOR0 feitas por PERF_BEGIN/PERF_END
+//!                 (lib/perf/perf.h) delimitam as regioes; o relatorio JSON traz
+//!                 chamadas e ciclos (min/medio/max/total) de cada regiao e o pior
+//!                 tempo de uma volta do laco principal.
+//!
+//!                 Firmware de medicao (mesmos fontes do projeto + PERF_ENABLE):
+//!                   avr-g++ -mmcu=atmega328p -Os -DF_CPU=16000000UL -DPERF_ENABLE
+//!                       -Ilib -Ilib/TWI -Ilib/MAX30102 -Ifonts -o oximetro.elf src/main.cpp
+//!                       lib/MAX30102/*_.cpp lib/TWI/twi_master_.cpp lib/st7735/st7735_.cpp
+//!                       lib/telemetry/telemetry_.cpp lib/hal/hal_.cpp lib/medicao/medicao_.cpp
+//!                       lib/sched/sched_.cpp
+//!                       lib/power/power_.cpp lib/buzzer/buzzer_.cpp
+//!                       lib/funsape/peripheral/funsapeLibUsart0.cpp
+//!                       lib/funsape/peripheral/funsapeLibInt0.cpp
+//!                       lib/funsape/peripheral/funsapeLibInt1.cpp
+//!                       lib/funsape/peripheral/funsapeLibTimer0.cpp
+//!                       lib/funsape/peripheral/funsapeLibTimer2.cpp
+//!                       lib/funsape/util/funsapeLibSystemStatus.cpp
+//!                 detectarValesEBPM (float) so existe fora do firmware normal:
+//!                 medir com tools/simavr/perf_calc.cpp.
+//!
+//!                 Harness:     gcc -O2 -Ilib/perf -o perf_harness tools/simavr/perf_harness.c
+//!                                  $(pkg-config --cflags --libs simavr) -lelf
+//!                 Uso:         ./perf_harness oximetro.elf [-c captura.csv] [-s segundos]
+//!                                  [-o relatorio.json] [-u] [-m]
+//!
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "sim_avr.h"
+#include "sim_elf.h"
+#include "sim_io.h"
+#include "sim_cycle_timers.h"
+#include "avr_twi.h"
+#include "avr_spi.h"
+#include "avr_uart.h"
+#include "avr_ioport.h"
+
+#include "perf.h"
+
+#define F_CPU               16000000UL
+#define GPIOR0_ENDERECO     0x3E            // GPIOR0 no espaco de dados do ATmega328P
+
+// =============================================================================
+// Captura (ou sinal interno quando nao ha arquivo)
+// =============================================================================
+
+typedef struct {
+    uint32_t* red;
+    uint32_t* ir;
+    size_t    n;
+    size_t    pos;
+} captura_t;
+
+static int captura_abre(captura_t* c, const char* arquivo)
+{
+    FILE* f = fopen(arquivo, "r");
+    if (!f) {
+        return -1;
+    }
+    size_t cap = 4096;
+    c->red = malloc(cap * sizeof(uint32_t));
+    c->ir  = malloc(cap * sizeof(uint32_t));
+    c->n   = 0;
+
+    char linha[96];
+    while (fgets(linha, sizeof(linha), f)) {
+        unsigned long v[3];
+        if (!isdigit((unsigned char)linha[0])) {
+            continue;
+        }
+        int campos = sscanf(linha, "%lu,%lu,%lu", &v[0], &v[1], &v[2]);
+        if (campos < 2) {
+            continue;
+        }
+        if (c->n == cap) {
+            cap *= 2;
+            c->red = realloc(c->red, cap * sizeof(uint32_t));
+            c->ir  = realloc(c->ir, cap * sizeof(uint32_t));
+        }
+        c->red[c->n] = (campos == 3) ? v[1] : v[0];
+        c->ir[c->n]  = (campos == 3) ? v[2] : v[1];
+        c->n++;
+    }
+    fclose(f);
+    return c->n ? 0 : -1;
+}
+
+// Proxima amostra; sem captura gera um pulso a cada 800 conversoes (75 bpm a 1000 sps) sobre DC de 100000
+static void captura_proxima(captura_t* c, uint32_t* red, uint32_t* ir)
+{
+    if (c->n) {
+        *red = c->red[c->pos];
+        *ir  = c->ir[c->pos];
+        c->pos = (c->pos + 1) % c->n;
+        return;
+    }
+    uint32_t fase = c->pos++ % 800;
+    uint32_t pulso = (fase < 120) ? fase * 25 : (fase < 400) ? 3000 - (fase - 120) * 3000 / 280 : 0;
+    *ir  = 100000 - pulso;
+    *red = 80000 - pulso / 2;
+}
+
+// =============================================================================
+// Modelo do MAX30102
+// =============================================================================
+
+enum {
+    REG_INT_STATUS_1 = 0x00, REG_INT_STATUS_2, REG_INT_ENABLE_1, REG_INT_ENABLE_2,
+    REG_FIFO_WR_PTR, REG_OVF_COUNTER, REG_FIFO_RD_PTR, REG_FIFO_DATA,
+    REG_FIFO_CONFIG, REG_MODE_CONFIG, REG_SPO2_CONFIG,
+    REG_DIE_TINT = 0x1F, REG_DIE_TFRAC, REG_DIE_TEMP_CONFIG,
+    REG_PROX_INT_THRESH = 0x30,
+    REG_PART_ID = 0xFF
+};
+
+typedef struct {
+    avr_t*     avr;
+    avr_irq_t* irq;                 // TWI_IRQ_OUTPUT/INPUT do lado do escravo
+    avr_irq_t* pino_int;            // PD2
+    captura_t* captura;
+    uint8_t    regs[256];
+    uint32_t   fifo_red[32];
+    uint32_t   fifo_ir[32];
+    uint8_t    wr, rd, ocupadas;
+    uint8_t    byte_amostra;        // 0..5 dentro da amostra lida em FIFO_DATA
+    uint8_t    selecionado;
+    uint8_t    indice;              // bytes escritos desde o START
+    uint8_t    ponteiro;            // registrador corrente
+    uint32_t   soma_red, soma_ir;   // media do chip (SMP_AVE) em andamento
+    uint8_t    somadas;
+    uint8_t    captura_com_media;   // -m: cada linha ja e uma amostra da FIFO
+    uint8_t    proximidade;         // so o LED piloto, FIFO parada ate PROX_INT
+    uint64_t   entregues;
+    uint64_t   perdidas;
+} max30102_t;
+
+// Ciclos entre conversoes na taxa de SPO2_CONFIG (SPO2_SR, bits 4:2)
+static avr_cycle_count_t max_periodo(const max30102_t* m)
+{
+    static const uint16_t taxas[8] = { 50, 100, 200, 400, 800, 1000, 1600, 3200 };
+    return F_CPU / taxas[(m->regs[REG_SPO2_CONFIG] >> 2) & 0x07];
+}
+
+// Conversoes por amostra na FIFO (SMP_AVE, bits 7:5 de FIFO_CONFIG)
+static uint8_t max_media(const max30102_t* m)
+{
+    uint8_t codigo = m->regs[REG_FIFO_CONFIG] >> 5;
+    return (uint8_t)(1 << (codigo > 5 ? 5 : codigo));
+}
+
+static void max_atualiza_pino(max30102_t* m)
+{
+    uint8_t ativo = (m->regs[REG_INT_STATUS_1] & m->regs[REG_INT_ENABLE_1]) ||
+                    (m->regs[REG_INT_STATUS_2] & m->regs[REG_INT_ENABLE_2]);
+    avr_raise_irq(m->pino_int, ativo ? 0 : 1);   // dreno aberto, ativo em 0
+}
+
+static void max_reset(max30102_t* m)
+{
+    memset(m->regs, 0, sizeof(m->regs));
+    m->regs[REG_PART_ID] = 0x15;
+    m->regs[0xFE] = 0x03;
+    m->wr = m->rd = m->ocupadas = 0;
+    m->byte_amostra = 0;
+    m->soma_red = m->soma_ir = 0;
+    m->somadas = 0;
+    m->proximidade = 0;
+    max_atualiza_pino(m);
+}
+
+// Fim da conversao de temperatura: 25.0 C e DIE_TEMP_RDY
+static avr_cycle_count_t max_temperatura(avr_t* avr, avr_cycle_count_t quando, void* param)
+{
+    max30102_t* m = (max30102_t*)param;
+    (void)avr;
+    (void)quando;
+
+    m->regs[REG_DIE_TINT]        = 25;
+    m->regs[REG_DIE_TFRAC]       = 0;
+    m->regs[REG_DIE_TEMP_CONFIG] = 0;               // TEMP_EN se apaga sozinho
+    m->regs[REG_INT_STATUS_2]   |= 0x02;
+    max_atualiza_pino(m);
+    return 0;
+}
+
+static avr_cycle_count_t max_amostra(avr_t* avr, avr_cycle_count_t quando, void* param)
+{
+    max30102_t* m = (max30102_t*)param;
+    (void)avr;
+
+    if ((m->regs[REG_MODE_CONFIG] & 0x07) == 0x03) {
+        uint32_t red, ir;
+        captura_proxima(m->captura, &red, &ir);
+
+        // Proximidade: compara os 8 MSBs do IR com PROX_INT_THRESH, sem encher a FIFO
+        if (m->proximidade) {
+            if ((ir >> 10) > m->regs[REG_PROX_INT_THRESH]) {
+                m->proximidade = 0;
+                m->regs[REG_INT_STATUS_1] |= 0x10;  // PROX_INT
+                max_atualiza_pino(m);
+            }
+            return quando + max_periodo(m);
+        }
+
+        // Media do chip: so a ultima conversao do grupo chega a FIFO
+        uint8_t media = m->captura_com_media ? 1 : max_media(m);
+        m->soma_red += red;
+        m->soma_ir  += ir;
+        if (++m->somadas < media) {
+            return quando + max_periodo(m);
+        }
+        red = m->soma_red / media;
+        ir  = m->soma_ir / media;
+        m->soma_red = m->soma_ir = 0;
+        m->somadas = 0;
+
+        if (m->ocupadas == 32) {
+            if (!(m->regs[REG_FIFO_CONFIG] & 0x10)) {
+                m->perdidas++;      // sem rollover: amostra nova descartada
+                return quando + max_periodo(m);
+            }
+            m->rd = (m->rd + 1) & 31;
+            m->ocupadas--;
+            m->perdidas++;
+            if (m->regs[REG_OVF_COUNTER] < 31) {
+                m->regs[REG_OVF_COUNTER]++;
+            }
+        }
+        m->fifo_red[m->wr] = red & 0x3FFFF;
+        m->fifo_ir[m->wr]  = ir & 0x3FFFF;
+        m->wr = (m->wr + 1) & 31;
+        m->ocupadas++;
+        m->entregues++;
+
+        if (m->ocupadas == 32 - (m->regs[REG_FIFO_CONFIG] & 0x0F)) {
+            m->regs[REG_INT_STATUS_1] |= 0x80;     // A_FULL
+        }
+        m->regs[REG_INT_STATUS_1] |= 0x40;         // PPG_RDY
+        max_atualiza_pino(m);
+    }
+    return quando + max_periodo(m);
+}
+
+static uint8_t max_le(max30102_t* m)
+{
+    uint8_t reg = m->ponteiro;
+
+    switch (reg) {
+    case REG_FIFO_WR_PTR: m->ponteiro++; return m->wr;     // lidos em rajada com OVF_COUNTER
+    case REG_FIFO_RD_PTR: m->ponteiro++; return m->rd;
+    case REG_FIFO_DATA: {
+        if (m->ocupadas == 0) {
+            return 0;
+        }
+        uint32_t v = (m->byte_amostra < 3) ? m->fifo_red[m->rd] : m->fifo_ir[m->rd];
+        uint8_t b = (uint8_t)(v >> (8 * (2 - m->byte_amostra % 3)));
+        if (++m->byte_amostra == 6) {
+            m->byte_amostra = 0;
+            m->rd = (m->rd + 1) & 31;
+            m->ocupadas--;
+            m->regs[REG_OVF_COUNTER] = 0;          // zera ao entregar uma amostra
+        }
+        return b;                                  // FIFO_DATA nao avanca o ponteiro
+    }
+    default:
+        break;
+    }
+
+    uint8_t v = m->regs[reg];
+    if (reg == REG_INT_STATUS_1 || reg == REG_INT_STATUS_2) {
+        m->regs[reg] = 0;                          // leitura limpa o status
+        max_atualiza_pino(m);
+    }
+    m->ponteiro++;
+    return v;
+}
+
+static void max_escreve(max30102_t* m, uint8_t v)
+{
+    uint8_t reg = m->ponteiro++;
+
+    switch (reg) {
+    case REG_FIFO_WR_PTR: m->wr = v & 31; break;
+    case REG_FIFO_RD_PTR: m->rd = v & 31; m->byte_amostra = 0; break;
+    case REG_OVF_COUNTER: m->regs[reg] = v & 31; break;
+    case REG_MODE_CONFIG:
+        if (v & 0x40) {                            // RESET
+            max_reset(m);
+            return;
+        }
+        m->regs[reg] = v;
+        // Com PROX_INT_EN o chip entra no modo de proximidade a cada modo gravado
+        m->proximidade = (m->regs[REG_INT_ENABLE_1] & 0x10) != 0;
+        break;
+    case REG_DIE_TEMP_CONFIG:
+        m->regs[reg] = v & 0x01;
+        if (v & 0x01) {
+            avr_cycle_timer_register(m->avr, F_CPU / 1000 * 29, max_temperatura, m);
+        }
+        break;
+    default:
+        m->regs[reg] = v;
+        break;
+    }
+    if (reg == REG_FIFO_WR_PTR || reg == REG_FIFO_RD_PTR) {
+        m->ocupadas = (m->wr - m->rd) & 31;
+        m->regs[REG_OVF_COUNTER] = 0;
+    }
+    if (reg == REG_INT_ENABLE_1 || reg == REG_INT_ENABLE_2) {
+        max_atualiza_pino(m);
+    }
+}
+
+// Mesmo protocolo do i2c_eeprom dos exemplos do simavr
+static void max_twi(struct avr_irq_t* irq, uint32_t valor, void* param)
+{
+    max30102_t* m = (max30102_t*)param;
+    avr_twi_msg_irq_t v;
+    v.u.v = valor;
+    (void)irq;
+
+    if (v.u.twi.msg & TWI_COND_STOP) {
+        m->selecionado = 0;
+    }
+    if (v.u.twi.msg & TWI_COND_START) {
+        m->selecionado = 0;
+        m->indice = 0;
+        if ((v.u.twi.addr >> 1) == 0x57) {
+            m->selecionado = v.u.twi.addr;
+            avr_raise_irq(m->irq + TWI_IRQ_INPUT, avr_twi_irq_msg(TWI_COND_ACK, m->selecionado, 1));
+        }
+    }
+    if (!m->selecionado) {
+        return;
+    }
+    if (v.u.twi.msg & TWI_COND_WRITE) {
+        avr_raise_irq(m->irq + TWI_IRQ_INPUT, avr_twi_irq_msg(TWI_COND_ACK, m->selecionado, 1));
+        if (m->indice++ == 0) {
+            m->ponteiro = v.u.twi.data;
+        } else {
+            max_escreve(m, v.u.twi.data);
+        }
+    }
+    if (v.u.twi.msg & TWI_COND_READ) {
+        avr_raise_irq(m->irq + TWI_IRQ_INPUT, avr_twi_irq_msg(TWI_COND_READ, m->selecionado, max_le(m)));
+    }
+}
+
+static const char* nomes_twi[] = { "8<max30102.out", "8>max30102.in" };
+
+static void max_conecta(avr_t* avr, max30102_t* m, captura_t* c, int com_media)
+{
+    memset(m, 0, sizeof(*m));
+    m->avr      = avr;
+    m->captura  = c;
+    m->captura_com_media = (uint8_t)com_media;
+    m->irq      = avr_alloc_irq(&avr->irq_pool, 0, 2, nomes_twi);
+    m->pino_int = avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ('D'), 2);
+    avr_irq_register_notify(m->irq + TWI_IRQ_OUTPUT, max_twi, m);
+    avr_connect_irq(m->irq + TWI_IRQ_INPUT, avr_io_getirq(avr, AVR_IOCTL_TWI_GETIRQ(0), TWI_IRQ_INPUT));
+    avr_connect_irq(avr_io_getirq(avr, AVR_IOCTL_TWI_GETIRQ(0), TWI_IRQ_OUTPUT), m->irq + TWI_IRQ_OUTPUT);
+    max_reset(m);
+    avr_cycle_timer_register(avr, max_periodo(m), max_amostra, m);
+}
+
+// =============================================================================
+// SPI, USART e marcadores de regiao
+// =============================================================================
+
+static uint64_t bytes_spi  = 0;
+static uint64_t bytes_uart = 0;
+static int      eco_uart   = 0;
+
+static void spi_sorvedouro(struct avr_irq_t* irq, uint32_t valor, void* param)
+{
+    (void)irq; (void)valor; (void)param;
+    bytes_spi++;
+}
+
+static void uart_saida(struct avr_irq_t* irq, uint32_t valor, void* param)
+{
+    (void)irq; (void)param;
+    bytes_uart++;
+    if (eco_uart) {
+        fputc((int)valor, stderr);
+    }
+}
+
+typedef struct {
+    const char* nome;
+    uint64_t    chamadas;
+    uint64_t    total;
+    uint64_t    minimo;
+    uint64_t    maximo;
+    uint64_t    inicio;
+    int         aberta;
+} regiao_t;
+
+#define PERF_NOME_(nome, id, texto) [id] = texto,
+static const char* nomes_regiao[PERF_TOTAL_REGIOES] = { PERF_REGIOES(PERF_NOME_) };
+#undef PERF_NOME_
+
+static regiao_t regioes[PERF_TOTAL_REGIOES];
+static uint64_t marcadores_invalidos = 0;
+
+static void perf_marcador(struct avr_t* avr, avr_io_addr_t endereco, uint8_t v, void* param)
+{
+    (void)param;
+    avr->data[endereco] = v;
+
+    uint8_t id = v & ~PERF_FIM;
+    if (id == 0 || id >= PERF_TOTAL_REGIOES) {
+        marcadores_invalidos++;
+        return;
+    }
+    regiao_t* r = &regioes[id];
+    if (!(v & PERF_FIM)) {
+        r->inicio = avr->cycle;
+        r->aberta = 1;
+        return;
+    }
+    if (!r->aberta) {
+        marcadores_invalidos++;
+        return;
+    }
+    uint64_t d = avr->cycle - r->inicio;
+    r->aberta = 0;
+    r->chamadas++;
+    r->total += d;
+    if (r->chamadas == 1 || d < r->minimo) r->minimo = d;
+    if (d > r->maximo) r->maximo = d;
+}
+
+// =============================================================================
+// Relatorio
+// =============================================================================
+
+static void relatorio(FILE* f, const char* elf, avr_t* avr, const max30102_t* m, const char* estado)
+{
+    fprintf(f, "{\n");
+    fprintf(f, "  \"firmware\": \"%s\",\n", elf);
+    fprintf(f, "  \"f_cpu\": %lu,\n", (unsigned long)F_CPU);
+    fprintf(f, "  \"estado_final\": \"%s\",\n", estado);
+    fprintf(f, "  \"ciclos_simulados\": %llu,\n", (unsigned long long)avr->cycle);
+    fprintf(f, "  \"segundos_simulados\": %.6f,\n", (double)avr->cycle / F_CPU);
+    fprintf(f, "  \"amostras_entregues\": %llu,\n", (unsigned long long)m->entregues);
+    fprintf(f, "  \"amostras_perdidas_fifo\": %llu,\n", (unsigned long long)m->perdidas);
+    fprintf(f, "  \"bytes_spi\": %llu,\n", (unsigned long long)bytes_spi);
+    fprintf(f, "  \"bytes_uart\": %llu,\n", (unsigned long long)bytes_uart);
+    fprintf(f, "  \"marcadores_invalidos\": %llu,\n", (unsigned long long)marcadores_invalidos);
+    fprintf(f, "  \"regioes\": [");
+    int primeira = 1;
+    for (int id = 1; id < PERF_TOTAL_REGIOES; id++) {
+        const regiao_t* r = &regioes[id];
+        fprintf(f, "%s\n    {\"id\": %d, \"nome\": \"%s\", \"chamadas\": %llu", primeira ? "" : ",",
+                id, nomes_regiao[id] ? nomes_regiao[id] : "?", (unsigned long long)r->chamadas);
+        primeira = 0;
+        if (r->chamadas) {
+            fprintf(f, ", \"ciclos_min\": %llu, \"ciclos_medio\": %.1f, \"ciclos_max\": %llu, "
+                       "\"ciclos_total\": %llu, \"us_max\": %.2f",
+                    (unsigned long long)r->minimo, (double)r->total / r->chamadas,
+                    (unsigned long long)r->maximo, (unsigned long long)r->total,
+                    r->maximo * 1e6 / F_CPU);
+        }
+        fprintf(f, "}");
+    }
+    fprintf(f, "\n  ],\n");
+    const regiao_t* laco = &regioes[PERF_LACO];
+    fprintf(f, "  \"pior_laco_ciclos\": %llu,\n", (unsigned long long)laco->maximo);
+    fprintf(f, "  \"pior_laco_us\": %.2f\n", laco->maximo * 1e6 / F_CPU);
+    fprintf(f, "}\n");
+}
+
+int main(int argc, char** argv)
+{
+    const char* elf = NULL;
+    const char* arquivo_captura = NULL;
+    const char* saida = NULL;
+    double segundos = 10.0;
+    int com_media = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-c") && i + 1 < argc)      arquivo_captura = argv[++i];
+        else if (!strcmp(argv[i], "-s") && i + 1 < argc) segundos = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-o") && i + 1 < argc) saida = argv[++i];
+        else if (!strcmp(argv[i], "-u"))                 eco_uart = 1;
+        else if (!strcmp(argv[i], "-m"))                 com_media = 1;
+        else                                             elf = argv[i];
+    }
+    if (!elf) {
+        fprintf(stderr, "uso: %s firmware.elf [-c captura.csv] [-s segundos] [-o relatorio.json] [-u] [-m]\n", argv[0]);
+        return 1;
+    }
+
+    captura_t captura = {0};
+    if (arquivo_captura && captura_abre(&captura, arquivo_captura) != 0) {
+        fprintf(stderr, "%s: captura vazia ou ilegivel\n", arquivo_captura);
+        return 1;
+    }
+
+    elf_firmware_t firmware = {0};
+    if (elf_read_firmware(elf, &firmware) != 0) {
+        fprintf(stderr, "%s: ELF invalido\n", elf);
+        return 1;
+    }
+    avr_t* avr = avr_make_mcu_by_name("atmega328p");
+    if (!avr) {
+        fprintf(stderr, "simavr sem suporte ao atmega328p\n");
+        return 1;
+    }
+    avr_init(avr);
+    avr->frequency = F_CPU;
+    avr_load_firmware(avr, &firmware);
+
+    // USART fora do stdout do simavr: o relatorio pode ir para stdout
+    uint32_t flags = 0;
+    avr_ioctl(avr, AVR_IOCTL_UART_GET_FLAGS('0'), &flags);
+    flags &= ~AVR_UART_FLAG_STDIO;
+    avr_ioctl(avr, AVR_IOCTL_UART_SET_FLAGS('0'), &flags);
+    avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_UART_GETIRQ('0'), UART_IRQ_OUTPUT), uart_saida, NULL);
+
+    avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_SPI_GETIRQ(0), SPI_IRQ_OUTPUT), spi_sorvedouro, NULL);
+    avr_register_io_write(avr, GPIOR0_ENDERECO, perf_marcador, NULL);
+
+    static max30102_t sensor;
+    max_conecta(avr, &sensor, &captura, com_media);
+
+    const avr_cycle_count_t limite = (avr_cycle_count_t)(segundos * F_CPU);
+    int estado = cpu_Running;
+    while (avr->cycle < limite) {
+        estado = avr_run(avr);
+        if (estado == cpu_Done || estado == cpu_Crashed) {
+            break;
+        }
+    }
+
+    const char* nome_estado = (estado == cpu_Crashed) ? "crash" : (estado == cpu_Done) ? "fim" : "limite";
+    FILE* f = saida ? fopen(saida, "w") : stdout;
+    if (!f) {
+        perror(saida);
+        return 1;
+    }
+    relatorio(f, elf, avr, &sensor, nome_estado);
+    if (f != stdout) {
+        fclose(f);
+    }
+    return (estado == cpu_Crashed) ? 2 : 0;
+}
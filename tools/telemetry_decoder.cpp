@@ -0,0 +1,174 @@
+//!
+//! \file           telemetry_decoder.cpp
+//! \brief          Decodificador (Linux) da telemetria binaria do oximetro
+//! \author         Paulo Donizete Antunes Junior
+//! \date           2025-08-10
+//! \version        1.0
+//! \details        Le o fluxo de quadros COBS gerado por lib/telemetry e
+//!                 escreve um CSV (amostra,red,ir) na saida padrao. Texto de
+//!                 printf misturado ao fluxo e quadros corrompidos sao
+//!                 descartados pelo CRC; lacunas de sequencia sao contadas.
+//!
+//!                 Compilacao:  g++ -O2 -o telemetry_decoder tools/telemetry_decoder.cpp
+//!                 Uso:         ./telemetry_decoder /dev/ttyUSB0 > captura.csv
+//!                              ./telemetry_decoder captura.bin  > captura.csv
+//!                 Sem argumento le da entrada padrao. Ctrl+C encerra a captura.
+//!
+
+#include "../lib/telemetry/telemetry.h"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <vector>
+
+static volatile sig_atomic_t encerrar = 0;
+
+static void trataSinal(int) {
+    encerrar = 1;
+}
+
+static uint8_t crc8(const uint8_t* data, size_t len) {
+    uint8_t crc = 0x00;
+
+    while (len--) {
+        crc ^= *data++;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ TELEMETRIA_CRC8_POLY) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// Decodifica um bloco COBS (sem os delimitadores). Retorna false se malformado.
+static bool cobsDecode(const std::vector<uint8_t>& in, std::vector<uint8_t>& out) {
+    out.clear();
+    size_t i = 0;
+    while (i < in.size()) {
+        uint8_t code = in[i++];
+        if (code == 0 || i + code - 1 > in.size()) {
+            return false;
+        }
+        for (uint8_t k = 1; k < code; k++) {
+            out.push_back(in[i++]);
+        }
+        if (code < 0xFF && i < in.size()) {
+            out.push_back(0x00);
+        }
+    }
+    return true;
+}
+
+// Le 18 bits MSB primeiro a partir do bit 'pos' do payload
+static uint32_t le18(const uint8_t* data, size_t pos) {
+    uint32_t valor = 0;
+    for (int b = 0; b < 18; b++, pos++) {
+        valor = (valor << 1) | ((data[pos >> 3] >> (7 - (pos & 7))) & 1);
+    }
+    return valor;
+}
+
+// Configura a porta serial em modo cru a 1 Mbaud (ignorado se nao for tty)
+static void configuraSerial(int fd) {
+    struct termios tio;
+    if (tcgetattr(fd, &tio) != 0) {
+        return;
+    }
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, B1000000);
+    cfsetospeed(&tio, B1000000);
+    tio.c_cc[VMIN]  = 1;
+    tio.c_cc[VTIME] = 0;
+    tcsetattr(fd, TCSANOW, &tio);
+}
+
+int main(int argc, char** argv) {
+    int fd = STDIN_FILENO;
+    if (argc > 1) {
+        fd = open(argv[1], O_RDONLY | O_NOCTTY);
+        if (fd < 0) {
+            perror(argv[1]);
+            return 1;
+        }
+        configuraSerial(fd);
+    }
+
+    signal(SIGINT, trataSinal);
+
+    unsigned long quadros = 0, erros = 0, perdidas = 0, amostras = 0;
+    bool temSeq = false;
+    uint16_t proximaSeq = 0;
+    uint32_t indice = 0;          // indice absoluto da amostra (estende seq de 16 bits)
+
+    std::vector<uint8_t> bloco, quadro;
+    uint8_t buf[512];
+
+    printf("amostra,red,ir\n");
+
+    while (!encerrar) {
+        ssize_t n = read(fd, buf, sizeof(buf));
+        if (n <= 0) {
+            break;
+        }
+
+        for (ssize_t k = 0; k < n; k++) {
+            if (buf[k] != 0x00) {
+                bloco.push_back(buf[k]);
+                continue;
+            }
+            if (bloco.empty()) {
+                continue;
+            }
+
+            // Bloco completo entre delimitadores
+            bool ok = cobsDecode(bloco, quadro) &&
+                      quadro.size() > TELEMETRIA_CABECALHO &&
+                      crc8(quadro.data(), quadro.size() - 1) == quadro.back() &&
+                      quadro[0] == TELEMETRIA_TIPO_AMOSTRAS;
+            bloco.clear();
+
+            uint8_t nAmostras = ok ? quadro[3] : 0;
+            if (ok && quadro.size() != TELEMETRIA_CABECALHO + TELEMETRIA_BYTES_AMOSTRAS(nAmostras) + 1u) {
+                ok = false;
+            }
+            if (!ok) {
+                erros++;
+                continue;
+            }
+
+            uint16_t seq = (uint16_t)(quadro[1] | (quadro[2] << 8));
+            if (!temSeq) {
+                indice = seq;
+            } else if (seq != proximaSeq && seq != 0) {
+                // seq = 0 fora de ordem e reinicio do fluxo (reentrada no modo debug)
+                uint16_t lacuna = (uint16_t)(seq - proximaSeq);
+                perdidas += lacuna;
+                indice   += lacuna;
+            }
+            temSeq = true;
+            proximaSeq = (uint16_t)(seq + nAmostras);
+
+            const uint8_t* payload = &quadro[TELEMETRIA_CABECALHO];
+            for (uint8_t a = 0; a < nAmostras; a++) {
+                uint32_t red = le18(payload, a * 36u);
+                uint32_t ir  = le18(payload, a * 36u + 18);
+                printf("%lu,%lu,%lu\n", (unsigned long)indice++, (unsigned long)red, (unsigned long)ir);
+            }
+            quadros++;
+            amostras += nAmostras;
+        }
+    }
+
+    fflush(stdout);
+    fprintf(stderr, "quadros: %lu  amostras: %lu  perdidas: %lu  descartados (CRC/COBS): %lu\n",
+            quadros, amostras, perdidas, erros);
+
+    if (fd != STDIN_FILENO) {
+        close(fd);
+    }
+    return 0;
+}